@@ -1,8 +1,9 @@
-TEMPLATE = subdirs
-
-CONFIG = ordered
-
-SUBDIRS += simplecharts \
-    simplecharts2
-
-
+TEMPLATE = subdirs
+
+CONFIG = ordered
+
+SUBDIRS += simplecharts \
+    simplecharts2 \
+    chartsbench
+
+
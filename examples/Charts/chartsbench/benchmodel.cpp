@@ -0,0 +1,63 @@
+#include "benchmodel.h"
+
+#include <QColor>
+
+
+BenchModel::BenchModel(int rows, int columns, QObject *parent) :
+    QAbstractTableModel(parent),
+    m_rows(rows),
+    m_columns(columns)
+{
+    m_values.resize(rows * columns);
+
+    for (int i = 0; i < m_values.count(); i++)
+        m_values[i] = 1 + (i * 7919) % 10;
+}
+
+
+int BenchModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+
+int BenchModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_columns;
+}
+
+
+QVariant BenchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+
+    return m_values.at(index.column() * m_rows + index.row());
+}
+
+
+QVariant BenchModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Vertical)
+    {
+        if (role == Qt::BackgroundRole)
+            return QColor::fromHsv((section * 47) % 360, 160, 230);
+
+        if (role == Qt::ForegroundRole)
+            return QColor(Qt::black);
+    }
+
+    if (role == Qt::DisplayRole)
+        return section + 1;
+
+    return QVariant();
+}
+
+
+void BenchModel::setValue(int row, int column, double value)
+{
+    m_values[column * m_rows + row] = value;
+
+    QModelIndex idx(index(row, column));
+    Q_EMIT dataChanged(idx, idx);
+}
@@ -0,0 +1,28 @@
+#ifndef BENCHMODEL_H
+#define BENCHMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+/// Lightweight table of numbers (QStandardItemModel is too heavy for millions of cells).
+class BenchModel : public QAbstractTableModel
+{
+public:
+    BenchModel(int rows, int columns, QObject *parent = 0);
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    /// Changes the value of the cell and emits dataChanged().
+    void setValue(int row, int column, double value);
+
+private:
+    int m_rows;
+    int m_columns;
+    QVector<double> m_values;
+};
+
+#endif // BENCHMODEL_H
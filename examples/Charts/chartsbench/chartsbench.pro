@@ -0,0 +1,10 @@
+include (../Charts.pri)
+
+TARGET = chartsbench
+
+CONFIG += console
+
+SOURCES += main.cpp\
+        benchmodel.cpp
+
+HEADERS  += benchmodel.h
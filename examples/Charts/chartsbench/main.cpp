@@ -0,0 +1,358 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QStringList>
+
+#include <QSintCharts>
+
+#include "benchmodel.h"
+
+using namespace QSint;
+
+
+// Counting of the heap allocations (glibc only): malloc() of the whole process is replaced.
+#if defined(__GLIBC__)
+
+#define ALLOCATION_COUNTING
+
+extern "C"
+{
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+}
+
+static int s_allocations = 0;
+
+extern "C" void *malloc(size_t size) __THROW
+{
+    __sync_fetch_and_add(&s_allocations, 1);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) __THROW
+{
+    __sync_fetch_and_add(&s_allocations, 1);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) __THROW
+{
+    __sync_fetch_and_add(&s_allocations, 1);
+    return __libc_realloc(ptr, size);
+}
+
+static int allocations()
+{
+    return __sync_fetch_and_add(&s_allocations, 0);
+}
+
+#else
+
+static int allocations()
+{
+    return 0;
+}
+
+#endif
+
+
+enum Phase
+{
+    /// layout and painting of the whole content
+    FullPaint,
+    /// moving of the mouse over the items
+    Hover,
+    /// changing of a single model value
+    Update,
+    /// resizing of the plotter
+    Resize,
+
+    PhaseCount
+};
+
+static const char *phaseNames[PhaseCount] = { "paint", "hover", "update", "resize" };
+
+static const char *chartNames[] = { "Stacked", "Columns", "Trend", "Pie", "Ring" };
+static const int chartCount = 5;
+
+static const QSize plotterSize(800, 600);
+static const QSize resizedSize(640, 480);
+
+// every phase is repeated at least minFrames times and at least minTime ms
+static const int minFrames = 3;
+static const int maxFrames = 1000;
+static const qint64 minTime = 200;
+
+
+struct Result
+{
+    int frames;
+    qint64 nsecs;
+    int allocations;
+};
+
+
+static PlotterBase* createPlotter(int type, int rows, QWidget *parent)
+{
+    switch (type)
+    {
+    case ChartRenderer::Pie:
+        return new PieChart(parent);
+
+    case ChartRenderer::Ring:
+        return new RingChart(parent);
+
+    default:
+        BarChartPlotter *plotter = new BarChartPlotter(parent);
+        plotter->setBarType(BarChartPlotter::BarChartType(type));
+
+        // model values are from 1 to 10
+        plotter->axisY()->setRanges(0, type == ChartRenderer::Stacked ? rows * 10 : 10);
+        plotter->axisY()->setTicks(1, 5);
+
+        return plotter;
+
+    } // switch
+}
+
+
+/// Makes a single change of the \a phase and repaints the plotter synchronously.
+static void step(PlotterBase *plotter, BenchModel *model, Phase phase, int i)
+{
+    switch (phase)
+    {
+    case FullPaint:
+        plotter->scheduleUpdate();
+        break;
+
+    case Hover:
+    {
+        // points spread over the plotter, so the highlighted item changes
+        QPoint pos(plotter->width() * (i % 16 * 2 + 1) / 32,
+                   plotter->height() * (i * 7 % 16 * 2 + 1) / 32);
+
+        QMouseEvent event(QEvent::MouseMove, pos, Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(plotter, &event);
+        break;
+    }
+
+    case Update:
+    {
+        int rows = model->rowCount();
+        int cell = int((i * 7919LL) % (rows * model->columnCount()));
+
+        model->setValue(cell % rows, cell / rows, 1 + i % 10);
+        break;
+    }
+
+    case Resize:
+        plotter->resize(i & 1 ? resizedSize : plotterSize);
+        break;
+
+    default:
+        break;
+
+    } // switch
+
+    // the whole widget is repainted, so hover frames include blitting of the cached content
+    plotter->repaint();
+}
+
+
+static Result measure(PlotterBase *plotter, BenchModel *model, Phase phase)
+{
+    // untimed frame brings the cached content into the steady state
+    step(plotter, model, phase, 0);
+
+    Result result;
+    result.frames = 0;
+
+    int allocs = allocations();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (;;)
+    {
+        step(plotter, model, phase, ++result.frames);
+
+        if ((result.frames >= minFrames && timer.elapsed() >= minTime) || result.frames >= maxFrames)
+            break;
+    }
+
+    result.nsecs = timer.nsecsElapsed();
+    result.allocations = allocations() - allocs;
+
+    if (phase == Resize)
+        plotter->resize(plotterSize);
+
+    return result;
+}
+
+
+static void run(int type, int cells, QWidget *host)
+{
+    // pie chart shows a single column of the model
+    int rows = (type == ChartRenderer::Pie) ? cells : qMin(cells, 8);
+    int columns = cells / rows;
+    cells = rows * columns;
+
+    BenchModel model(rows, columns);
+
+    PlotterBase *plotter = createPlotter(type, rows, host);
+    plotter->setGeometry(QRect(QPoint(), plotterSize));
+    plotter->setModel(&model);
+    plotter->show();
+
+    for (int phase = 0; phase < PhaseCount; phase++)
+    {
+        Result result = measure(plotter, &model, Phase(phase));
+
+        double frameTime = double(result.nsecs) / result.frames;
+
+        printf("%-8s %8d %-7s %6d %12.3f %12.3f", chartNames[type], cells, phaseNames[phase],
+               result.frames, frameTime / 1000000, frameTime / cells);
+
+#ifdef ALLOCATION_COUNTING
+        printf(" %12.1f\n", double(result.allocations) / result.frames);
+#else
+        printf(" %12s\n", "n/a");
+#endif
+
+        fflush(stdout);
+    }
+
+    delete plotter;
+}
+
+
+/// Compares text of \a value written by ValueFormatter with the one of QString::number().
+static void compareFormat(double value, int &count, int &differences)
+{
+    char buffer[ValueFormatter::MaxNumberLength];
+    int length = ValueFormatter::formatNumber(value, buffer);
+
+    QString text(QString::fromLatin1(buffer, length));
+    QString expected(QString::number(value));
+
+    count++;
+
+    if (text == expected)
+        return;
+
+    if (differences < 20)
+        printf("%.17g: %s, QString::number(): %s\n", value, qPrintable(text), qPrintable(expected));
+
+    differences++;
+}
+
+
+/// Checks ValueFormatter near the rounding ties, near the powers of 10 and at the extremes.
+/// Returns the number of the values written differently than by QString::number().
+static int checkFormat()
+{
+    int count = 0, differences = 0;
+
+    srand(1);
+
+    for (int k = -323; k <= 308; k++)
+    {
+        double power = pow(10.0, k);
+
+        compareFormat(power, count, differences);
+        compareFormat(power * (1 - DBL_EPSILON), count, differences);
+        compareFormat(power * (1 + DBL_EPSILON), count, differences);
+        compareFormat(power * 9.999995, count, differences);
+
+        // decimal ties (d + 0.5) * 10^k and their neighbours
+        for (int i = 0; i < 100; i++)
+        {
+            double tie = (100000 + rand() % 900000 + 0.5) * power;
+
+            compareFormat(tie, count, differences);
+            compareFormat(tie * (1 - DBL_EPSILON), count, differences);
+            compareFormat(tie * (1 + DBL_EPSILON), count, differences);
+        }
+    }
+
+    // exact binary ties
+    for (int i = 0; i < 100000; i++)
+    {
+        double digits = 1000000 + rand() % 9000000;
+        compareFormat(ldexp(digits * 2 + 1, rand() % 40 - 21), count, differences);
+    }
+
+    // usual values
+    for (int i = 0; i < 100000; i++)
+        compareFormat((rand() % 2000001 - 1000000) * pow(10.0, rand() % 13 - 8), count, differences);
+
+    const double extremes[] = { DBL_MAX, -DBL_MAX, DBL_MIN, 4.9406564584124654e-324, 0.1234565, 999999.5, 99999.95 };
+    for (unsigned i = 0; i < sizeof(extremes) / sizeof(double); i++)
+        compareFormat(extremes[i], count, differences);
+
+    printf("format: %d of %d values differ from QString::number()\n", differences, count);
+
+    return differences;
+}
+
+
+int main(int argc, char *argv[])
+{
+#if QT_VERSION >= 0x050000
+    // no window is needed for measuring
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+
+    QApplication a(argc, argv);
+
+    // usage: chartsbench [max cells] [chart types...]
+    //        chartsbench format (checks ValueFormatter against QString::number())
+    int maxCells = 1000000;
+    QList<int> types;
+
+    QStringList args(a.arguments().mid(1));
+
+    if (args.contains(QLatin1String("format")))
+        return checkFormat() ? 1 : 0;
+    for (int i = 0; i < args.count(); i++)
+    {
+        bool ok;
+        int cells = args.at(i).toInt(&ok);
+        if (ok)
+        {
+            maxCells = cells;
+            continue;
+        }
+
+        for (int t = 0; t < chartCount; t++)
+            if (args.at(i).compare(chartNames[t], Qt::CaseInsensitive) == 0)
+                types.append(t);
+    }
+
+    if (types.isEmpty())
+        for (int t = 0; t < chartCount; t++)
+            types.append(t);
+
+    // plotters are child widgets, so they are resized and repainted synchronously
+    QWidget host;
+    host.resize(plotterSize);
+    host.show();
+
+    for (int i = 0; i < 10; i++)
+        QCoreApplication::processEvents();
+
+    printf("%-8s %8s %-7s %6s %12s %12s %12s\n", "chart", "cells", "phase", "frames", "ms/frame", "ns/cell", "allocs/frame");
+
+    for (int t = 0; t < types.count(); t++)
+        for (int cells = 10; cells <= maxCells; cells *= 10)
+            run(types.at(t), cells, &host);
+
+    return 0;
+}
@@ -1,10 +1,10 @@
-include (../Charts.pri)
-
-TARGET = simplecharts
-
-SOURCES += main.cpp\
-        mainwidget.cpp
-
-HEADERS  += mainwidget.h
-
-FORMS    += mainwidget.ui
+include (../Charts.pri)
+
+TARGET = simplecharts
+
+SOURCES += main.cpp\
+        mainwidget.cpp
+
+HEADERS  += mainwidget.h
+
+FORMS    += mainwidget.ui
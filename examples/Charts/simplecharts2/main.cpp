@@ -1,11 +1,11 @@
-#include <QApplication>
-#include "mainwidget.h"
-
-int main(int argc, char *argv[])
-{
-    QApplication a(argc, argv);
-    MainWidget w;
-    w.showMaximized();
-
-    return a.exec();
-}
+#include <QApplication>
+#include "mainwidget.h"
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+    MainWidget w;
+    w.showMaximized();
+
+    return a.exec();
+}
@@ -1,9 +1,9 @@
-CONFIG(release,debug|release){
-    LIBNAME = QSCharts
-}
-
-CONFIG(debug,debug|release){
-    LIBNAME = QSChartsd
-}
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+CONFIG(release,debug|release){
+    LIBNAME = QSCharts
+}
+
+CONFIG(debug,debug|release){
+    LIBNAME = QSChartsd
+}
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
@@ -1,21 +1,30 @@
-include (Charts.pri)
-include (../src.pri)
-
-INCLUDEPATH += ./ ../Core
-
-
-HEADERS += \
-    plotterbase.h \
-    barchartplotter.h \
-    axisbase.h \
-    piechart.h \
-	ringchart.h \
-    paintscheme.h
-
-SOURCES += \
-    plotterbase.cpp \
-    barchartplotter.cpp \
-    axisbase.cpp \
-    piechart.cpp \
-	ringchart.cpp \
-    paintscheme.cpp
+include (Charts.pri)
+include (../src.pri)
+
+INCLUDEPATH += ./ ../Core
+
+
+HEADERS += \
+    plotterbase.h \
+    chartdata.h \
+    chartstreammodel.h \
+    barchartplotter.h \
+    axisbase.h \
+    piechart.h \
+	ringchart.h \
+    paintscheme.h \
+    chartrenderer.h \
+    chartsimd_p.h \
+    valueformatter.h
+
+SOURCES += \
+    plotterbase.cpp \
+    chartdata.cpp \
+    chartstreammodel.cpp \
+    barchartplotter.cpp \
+    axisbase.cpp \
+    piechart.cpp \
+	ringchart.cpp \
+    paintscheme.cpp \
+    chartrenderer.cpp \
+    valueformatter.cpp
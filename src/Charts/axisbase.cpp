@@ -1,390 +1,1071 @@
-#include "axisbase.h"
-
-
-namespace QSint
-{
-
-
-AxisBase::AxisBase(Qt::Orientation orient, PlotterBase *parent) :
-    QObject(parent),
-    m_orient(orient)
-{
-    setTicks(0, 10);
-    setRanges(0, 100);
-    setOffset(30);
-    setType(AxisData);
-
-    setMinorGridPen(Qt::NoPen);
-    setMajorGridPen(Qt::NoPen);
-
-    setModel(0);
-}
-
-
-void AxisBase::setType(AxisBase::AxisType type)
-{
-    m_type = type;
-}
-
-void AxisBase::setModel(QAbstractItemModel *model)
-{
-    m_model = model;
-}
-
-
-void AxisBase::setRanges(double min, double max)
-{
-    m_min = min;
-    m_max = qMax(max, m_min);
-}
-
-void AxisBase::setTicks(double minor, double major)
-{
-    m_minor = qMax(0.0, minor);
-    m_major = qMax(m_minor, major);
-}
-
-void AxisBase::setOffset(int offset)
-{
-    m_offset = qMax(0, offset);
-}
-
-void AxisBase::setFont(const QFont &font)
-{
-    m_font = font;
-}
-
-void AxisBase::setTextColor(const QColor &color)
-{
-    m_textColor = color;
-}
-
-void AxisBase::setPen(const QPen &pen)
-{
-    m_pen = pen;
-}
-
-void AxisBase::setMinorTicksPen(const QPen &pen)
-{
-    m_minorPen = pen;
-}
-
-void AxisBase::setMajorTicksPen(const QPen &pen)
-{
-    m_majorPen = pen;
-}
-
-void AxisBase::setMinorGridPen(const QPen &pen)
-{
-    m_minorGridPen = pen;
-}
-
-void AxisBase::setMajorGridPen(const QPen &pen)
-{
-    m_majorGridPen = pen;
-}
-
-
-void AxisBase::calculatePoints(int &p_start, int &p_end)
-{
-    PlotterBase *plotter = (PlotterBase*)parent();
-    QRect rect(plotter->dataRect());
-
-    switch (m_orient)
-    {
-        case Qt::Vertical:
-        {
-            p_start = rect.top() + 1;
-            p_end = rect.bottom();
-            if (p_end <= p_start) {
-                p_start = 0;
-                p_end = rect.height();
-            }
-            break;
-        }
-
-        case Qt::Horizontal:
-        {
-            p_start = rect.left();
-            p_end = rect.right() - 1;
-            if (p_end <= p_start) {
-                p_start = 0;
-                p_end = rect.width();
-            }
-            break;
-        }
-    }
-}
-
-int AxisBase::toView(double value)
-{
-    int p_start, p_end;
-    calculatePoints(p_start, p_end);
-
-    // add 5% to ensure that everything fits
-    double p10 = (m_max - m_min) * 0.05;
-
-    double d = (value - m_min) / (m_max - m_min + p10);
-
-    switch (m_orient)
-    {
-        case Qt::Vertical:
-            return p_end - d * (p_end - p_start);
-
-        case Qt::Horizontal:
-            return d * (p_end - p_start) + p_start;
-    }
-
-    return 0;
-}
-
-
-void AxisBase::draw(QPainter &p)
-{
-    switch (m_type)
-    {
-        case AxisModel:
-            drawAxisModel(p);
-            break;
-
-        default:
-            drawAxisData(p);
-            break;
-    }
-}
-
-void AxisBase::drawAxisData(QPainter &p)
-{
-    PlotterBase *plotter = (PlotterBase*)parent();
-    QRect rect(plotter->contentsRect());
-
-    double start = m_min;
-    double end = m_max;
-
-    int p_start, p_end;
-    calculatePoints(p_start, p_end);
-
-    switch (m_orient)
-    {
-        case Qt::Vertical:
-        {
-            p.setPen(m_pen);
-            p.drawLine(m_offset+2, p_start, m_offset+2, p_end);
-
-            if (m_minor > 1e-100)
-            {
-                int prevTick = INT_MAX/2;
-
-                for (double i = start; i <= end; i += m_minor)
-                {
-                    int p_d = toView(i);
-
-                    if (p_d < prevTick-1)
-                    {
-                        prevTick = p_d;
-                        p.setPen(m_minorPen);
-                        p.drawLine(m_offset+1, p_d, m_offset+3, p_d);
-
-                        if (m_minorGridPen != Qt::NoPen)
-                        {
-                            p.setPen(m_minorGridPen);
-                            p.drawLine(m_offset+2, p_d, rect.right(), p_d);
-                        }
-                    }
-                }
-            }
-
-            if (m_major > 1e-100)
-            {
-                QRect prevRect;
-                int prevTick = INT_MAX/2;
-
-                for (double i = start; i <= end; i += m_major)
-                {
-                    int p_d = toView(i);
-
-                    if (p_d < prevTick-1)
-                    {
-                        prevTick = p_d;
-                        p.setPen(m_majorPen);
-                        p.drawLine(m_offset+0, p_d, m_offset+4, p_d);
-
-                        if (m_majorGridPen != Qt::NoPen)
-                        {
-                            p.setPen(m_majorGridPen);
-                            p.drawLine(m_offset+2, p_d, rect.right(), p_d);
-                        }
-                    }
-
-                    QString text(QString::number(i));
-                    QFontMetrics fm(m_font);
-                    QRect textRect(fm.boundingRect(text));
-
-                    int h = textRect.height();
-                    QRect drawRect(0, p_d - h/2, m_offset, h);
-
-                    // skip paining the text
-                    if (prevRect.isValid() && prevRect.intersects(drawRect))
-                        continue;
-                    prevRect = drawRect;
-
-                    p.setPen(QPen(m_textColor));
-                    p.drawText(drawRect, Qt::AlignRight | Qt::AlignVCenter, text);
-                }
-            }
-
-            break;
-        }
-
-        case Qt::Horizontal:
-        {
-            p.setPen(m_pen);
-            p.drawLine(p_start, rect.height()-m_offset, p_end, rect.height()-m_offset);
-
-            if (m_minor > 1e-100)
-            {
-                int prevTick = -INT_MAX;
-
-                for (double i = start; i <= end; i += m_minor)
-                {
-                    int p_d = toView(i);
-
-                    if (p_d > prevTick+1)
-                    {
-                        prevTick = p_d;
-                        p.setPen(m_minorPen);
-                        p.drawLine(p_d, rect.height()-m_offset+1, p_d, rect.height()-m_offset+3);
-
-                        if (m_minorGridPen != Qt::NoPen)
-                        {
-                            p.setPen(m_minorGridPen);
-                            p.drawLine(p_d, rect.top(), p_d, rect.height()-m_offset);
-                        }
-                    }
-                }
-            }
-
-            if (m_major > 1e-100)
-            {
-                QRect prevRect;
-                int prevTick = -INT_MAX;
-
-                for (double i = start; i <= end; i += m_major)
-                {
-                    int p_d = toView(i);
-
-                    if (p_d > prevTick+1)
-                    {
-                        prevTick = p_d;
-                        p.setPen(m_majorPen);
-                        p.drawLine(p_d, rect.height()-m_offset+0, p_d, rect.height()-m_offset+4);
-
-                        if (m_majorGridPen != Qt::NoPen)
-                        {
-                            p.setPen(m_majorGridPen);
-                            p.drawLine(p_d, rect.top(), p_d, rect.height()-m_offset);
-                        }
-                    }
-
-                    QString text(QString::number(i));
-                    QFontMetrics fm(m_font);
-                    QRect textRect(fm.boundingRect(text));
-
-                    int w = textRect.width();
-                    QRect drawRect(p_d - w/2, rect.height()-m_offset+3, w, m_offset);
-
-                    // skip paining the text
-                    if (prevRect.isValid() && prevRect.intersects(drawRect))
-                        continue;
-                    prevRect = drawRect;
-
-                    p.setPen(QPen(m_textColor));
-                    p.drawText(drawRect, Qt::AlignCenter, text);
-                }
-            }
-
-            break;
-
-        }
-    }
-}
-
-void AxisBase::drawAxisModel(QPainter &p)
-{
-    PlotterBase *plotter = (PlotterBase*)parent();
-    QRect rect(plotter->contentsRect());
-
-    int p_start, p_end;
-    calculatePoints(p_start, p_end);
-
-    switch (m_orient)
-    {
-        case Qt::Vertical:
-        {
-            p.setPen(m_pen);
-            p.drawLine(m_offset+2, p_start, m_offset+2, p_end);
-
-            if (m_model)
-            {
-            }
-
-            break;
-        }
-
-        case Qt::Horizontal:
-        {
-            p.setPen(m_pen);
-            p.drawLine(p_start, rect.height()-m_offset, p_end, rect.height()-m_offset);
-
-            if (m_model)
-            {
-                int count = m_model->columnCount();
-				if (count <= 0)
-					return;
-
-                int p_offs = (p_end - p_start) / count;
-                int p_line_d = p_start + p_offs;
-
-				QRect prevRect;
-
-                for (int i = 0; i < count; i++)
-                {
-                    double d = (double)i / (double)count;
-                    int p_d = d * (p_end - p_start) + p_start + p_offs/2;
-
-                    p.setPen(m_majorPen);
-                    p.drawLine(p_d, rect.height()-m_offset+0, p_d, rect.height()-m_offset+4);
-
-                    if (m_majorGridPen != Qt::NoPen)
-                    {
-                        p.setPen(m_majorGridPen);
-                        p.drawLine(p_line_d, rect.top(), p_line_d, rect.height()-m_offset);
-                        p_line_d += p_offs;
-                    }
-
-                    QString text(m_model->headerData(i, m_orient).toString());
-                    QFontMetrics fm(m_font);
-                    QRect textRect(fm.boundingRect(text));
-
-                    int w = textRect.width() + 4;
-                    QRect drawRect(p_d - w/2, rect.height()-m_offset+3, w, m_offset);
-
-                    // skip paining the text
-                    if (prevRect.isValid() && prevRect.intersects(drawRect))
-                        continue;
-                    prevRect = drawRect;
-
-                    p.setPen(QPen(m_textColor));
-                    p.drawText(drawRect, Qt::AlignCenter, text);
-                }
-            }
-
-            break;
-        }
-
-    }
-
-}
-
-
-} // namespace
+#include "axisbase.h"
+#include "chartsimd_p.h"
+
+#include <QDateTime>
+#include <qmath.h>
+
+
+namespace QSint
+{
+
+
+AxisBase::AxisBase(Qt::Orientation orient, PlotterBase *parent) :
+    QObject(parent),
+    m_orient(orient),
+    m_autoTicks(false),
+    m_viewportFirst(0),
+    m_viewportSpan(0),
+    m_modelColumns(0),
+    m_culledLabels(0),
+    m_labelsValid(false),
+    m_timeSpec(Qt::LocalTime),
+    m_mappingValid(false)
+{
+    setTicks(0, 10);
+    setRanges(0, 100);
+    setOffset(30);
+    setType(AxisData);
+
+    setMinorGridPen(Qt::NoPen);
+    setMajorGridPen(Qt::NoPen);
+
+    setModel(0);
+}
+
+
+void AxisBase::setType(AxisBase::AxisType type)
+{
+    m_type = type;
+
+    m_labelsValid = false;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setModel(QAbstractItemModel *model)
+{
+    m_model = model;
+
+    m_labelsValid = false;
+}
+
+
+void AxisBase::setRanges(double min, double max)
+{
+    adjustRanges(min, max);
+
+    scheduleUpdate();
+}
+
+bool AxisBase::adjustRanges(double min, double max)
+{
+    max = qMax(max, min);
+
+    if (min == m_min && max == m_max)
+        return false;
+
+    m_min = min;
+    m_max = max;
+
+    m_mappingValid = false;
+    m_labelsValid = false;
+
+    return true;
+}
+
+void AxisBase::setTicks(double minor, double major)
+{
+    m_minor = qMax(0.0, minor);
+    m_major = qMax(m_minor, major);
+
+    m_labelsValid = false;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setAutoTicks(bool set)
+{
+    if (m_autoTicks == set)
+        return;
+
+    m_autoTicks = set;
+
+    m_labelsValid = false;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setTimeSpec(Qt::TimeSpec spec)
+{
+    if (m_timeSpec == spec)
+        return;
+
+    m_timeSpec = spec;
+
+    m_labelsValid = false;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setOffset(int offset)
+{
+    m_offset = qMax(0, offset);
+
+    // offset changes data rectangle of the plotter, i.e. mapping of the both axes
+    PlotterBase *plotter = (PlotterBase*)parent();
+    if (plotter)
+    {
+        if (plotter->axisX())
+            plotter->axisX()->invalidate();
+
+        if (plotter->axisY())
+            plotter->axisY()->invalidate();
+    }
+
+    invalidate();
+
+    scheduleUpdate();
+}
+
+void AxisBase::setViewport(int first, int span)
+{
+    first = qMax(0, first);
+    span = qMax(0, span);
+
+    if (first == m_viewportFirst && span == m_viewportSpan)
+        return;
+
+    m_viewportFirst = first;
+    m_viewportSpan = span;
+
+    m_labelsValid = false;
+
+    emit viewportChanged(first, span);
+
+    scheduleUpdate();
+}
+
+void AxisBase::visibleRange(int count, int &first, int &span) const
+{
+    count = qMax(0, count);
+
+    span = (m_viewportSpan > 0) ? qMin(m_viewportSpan, count) : count;
+    first = qBound(0, m_viewportFirst, count - span);
+}
+
+void AxisBase::setFont(const QFont &font)
+{
+    m_font = font;
+
+    m_labelsValid = false;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setTextColor(const QColor &color)
+{
+    m_textColor = color;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setPen(const QPen &pen)
+{
+    m_pen = pen;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setMinorTicksPen(const QPen &pen)
+{
+    m_minorPen = pen;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setMajorTicksPen(const QPen &pen)
+{
+    m_majorPen = pen;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setMinorGridPen(const QPen &pen)
+{
+    m_minorGridPen = pen;
+
+    scheduleUpdate();
+}
+
+void AxisBase::setMajorGridPen(const QPen &pen)
+{
+    m_majorGridPen = pen;
+
+    scheduleUpdate();
+}
+
+
+void AxisBase::scheduleUpdate()
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+    if (plotter)
+        plotter->scheduleUpdate();
+}
+
+
+void AxisBase::calculatePoints(int &p_start, int &p_end)
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+    QRect rect(plotter->dataRect());
+
+    switch (m_orient)
+    {
+        case Qt::Vertical:
+        {
+            p_start = rect.top() + 1;
+            p_end = rect.bottom();
+            if (p_end <= p_start) {
+                p_start = 0;
+                p_end = rect.height();
+            }
+            break;
+        }
+
+        case Qt::Horizontal:
+        {
+            p_start = rect.left();
+            p_end = rect.right() - 1;
+            if (p_end <= p_start) {
+                p_start = 0;
+                p_end = rect.width();
+            }
+            break;
+        }
+    }
+}
+
+void AxisBase::invalidate()
+{
+    m_mappingValid = false;
+    m_labelsValid = false;
+}
+
+void AxisBase::ensureMapping()
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+
+    if (m_mappingValid && m_mappingSize == plotter->size())
+        return;
+
+    int p_start, p_end;
+    calculatePoints(p_start, p_end);
+
+    m_viewStart = p_start;
+    m_viewEnd = p_end;
+    m_viewLength = p_end - p_start;
+
+    // add 5% to ensure that everything fits
+    double p10 = (m_max - m_min) * 0.05;
+
+    m_valueSpan = m_max - m_min + p10;
+
+    m_mappingSize = plotter->size();
+    m_mappingValid = true;
+}
+
+int AxisBase::toView(double value)
+{
+    ensureMapping();
+
+    double d = (value - m_min) / m_valueSpan;
+
+    switch (m_orient)
+    {
+        case Qt::Vertical:
+            return m_viewEnd - d * m_viewLength;
+
+        case Qt::Horizontal:
+            return d * m_viewLength + m_viewStart;
+    }
+
+    return 0;
+}
+
+void AxisBase::mapToView(const double *values, int *points, int count)
+{
+    ensureMapping();
+
+    // vertical: end - d * length, horizontal: start + d * length
+    double base = (m_orient == Qt::Vertical) ? m_viewEnd : m_viewStart;
+    double length = (m_orient == Qt::Vertical) ? -m_viewLength : m_viewLength;
+
+    int i = 0;
+
+#if defined(QSINT_CHARTS_AVX)
+    const __m256d v_min = _mm256_set1_pd(m_min);
+    const __m256d v_span = _mm256_set1_pd(m_valueSpan);
+    const __m256d v_length = _mm256_set1_pd(length);
+    const __m256d v_base = _mm256_set1_pd(base);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d d = _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(values + i), v_min), v_span);
+        __m256d p = _mm256_add_pd(v_base, _mm256_mul_pd(d, v_length));
+        _mm_storeu_si128((__m128i*)(points + i), _mm256_cvttpd_epi32(p));
+    }
+#elif defined(QSINT_CHARTS_SSE2)
+    const __m128d v_min = _mm_set1_pd(m_min);
+    const __m128d v_span = _mm_set1_pd(m_valueSpan);
+    const __m128d v_length = _mm_set1_pd(length);
+    const __m128d v_base = _mm_set1_pd(base);
+
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128d d = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(values + i), v_min), v_span);
+        __m128d p = _mm_add_pd(v_base, _mm_mul_pd(d, v_length));
+        _mm_storel_epi64((__m128i*)(points + i), _mm_cvttpd_epi32(p));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        double d = (values[i] - m_min) / m_valueSpan;
+        points[i] = base + d * length;
+    }
+}
+
+
+void AxisBase::draw(QPainter &p)
+{
+    switch (m_type)
+    {
+        case AxisModel:
+            drawAxisModel(p);
+            break;
+
+        default:
+            drawAxisData(p);
+            break;
+    }
+}
+
+void AxisBase::drawAxisData(QPainter &p)
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+    QRect rect(plotter->contentsRect());
+
+    int p_start, p_end;
+    calculatePoints(p_start, p_end);
+
+    p.setPen(m_pen);
+
+    if (m_orient == Qt::Vertical)
+        p.drawLine(m_offset+2, p_start, m_offset+2, p_end);
+    else
+        p.drawLine(p_start, rect.height()-m_offset, p_end, rect.height()-m_offset);
+
+    // ticks, grid and labels placed by calculateLabels()
+    drawTicks(p);
+
+    drawLabels(p);
+}
+
+void AxisBase::drawAxisModel(QPainter &p)
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+    QRect rect(plotter->contentsRect());
+
+    int p_start, p_end;
+    calculatePoints(p_start, p_end);
+
+    p.setPen(m_pen);
+
+    if (m_orient == Qt::Vertical)
+        p.drawLine(m_offset+2, p_start, m_offset+2, p_end);
+    else
+        p.drawLine(p_start, rect.height()-m_offset, p_end, rect.height()-m_offset);
+
+    // columns and labels placed by calculateLabels()
+    drawTicks(p);
+
+    drawLabels(p);
+}
+
+void AxisBase::drawTicks(QPainter &p)
+{
+    if (!m_minorTicks.isEmpty())
+    {
+        p.setPen(m_minorPen);
+        p.drawLines(m_minorTicks);
+
+        if (m_minorGridPen != Qt::NoPen)
+        {
+            p.setPen(m_minorGridPen);
+            p.drawLines(m_minorGrid);
+        }
+    }
+
+    if (!m_majorTicks.isEmpty())
+    {
+        p.setPen(m_majorPen);
+        p.drawLines(m_majorTicks);
+
+        if (m_majorGridPen != Qt::NoPen)
+        {
+            p.setPen(m_majorGridPen);
+            p.drawLines(m_majorGrid);
+        }
+    }
+}
+
+void AxisBase::drawLabels(QPainter &p)
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+    plotter->countLabels(m_labels.count(), m_culledLabels);
+
+    if (m_labels.isEmpty())
+        return;
+
+    // the texts are laid out for the font of the axis
+    QFont font(p.font());
+    p.setFont(m_font);
+    p.setPen(QPen(m_textColor));
+
+    for (int i = 0; i < m_labels.count(); i++)
+    {
+        const Label &label = m_labels.at(i);
+        p.drawStaticText(label.pos, label.staticText);
+    }
+
+    p.setFont(font);
+}
+
+
+void AxisBase::calculateLabels()
+{
+    // painting (possibly by several threads) only reads the mapping
+    ensureMapping();
+
+    PlotterBase *plotter = (PlotterBase*)parent();
+
+    if (m_labelsValid && m_labelsSize == plotter->size())
+        return;
+
+    m_labelsSize = plotter->size();
+    m_labelsValid = true;
+
+    m_modelColumns = 0;
+    m_culledLabels = 0;
+    m_labels.clear();
+
+    m_minorTicks.clear();
+    m_minorGrid.clear();
+    m_majorTicks.clear();
+    m_majorGrid.clear();
+
+    switch (m_type)
+    {
+        case AxisModel:
+            calculateModelLabels();
+            break;
+
+        case AxisTime:
+            calculateTimeLabels();
+            break;
+
+        default:
+            calculateDataLabels();
+            break;
+    }
+}
+
+/// Converts \a index of a tick to the integer, limited to avoid the overflow.
+static qint64 tickIndex(double index)
+{
+    return qint64(qBound(-1e15, index, 1e15));
+}
+
+void AxisBase::calculateDataLabels()
+{
+    if (m_viewLength <= 0 || m_valueSpan <= 0)
+        return;
+
+    QFontMetrics fm(m_font);
+
+    if (m_autoTicks)
+    {
+        double minor, major;
+        calculateAutoTicks(fm, minor, major);
+
+        // placed on the multiples of the steps
+        if (minor > 0)
+            addDataTicks(0, minor, tickIndex(ceil(m_min / minor)), tickIndex(floor(m_max / minor)), false, fm);
+
+        addDataTicks(0, major, tickIndex(ceil(m_min / major)), tickIndex(floor(m_max / major)), true, fm);
+
+        return;
+    }
+
+    // placed from the minimum
+    if (m_minor > 1e-100)
+        addDataTicks(m_min, m_minor, 0, tickIndex(floor((m_max - m_min) / m_minor + 1e-9)), false, fm);
+
+    if (m_major > 1e-100)
+        addDataTicks(m_min, m_major, 0, tickIndex(floor((m_max - m_min) / m_major + 1e-9)), true, fm);
+}
+
+void AxisBase::calculateAutoTicks(const QFontMetrics &fm, double &minor, double &major) const
+{
+    // space taken by a label
+    int extent;
+
+    if (m_orient == Qt::Vertical)
+        extent = fm.height() * 2;
+    else
+        extent = qMax(fm.width(QString::number(m_min)), fm.width(QString::number(m_max)))
+                + fm.width(QLatin1Char('0')) * 2 + 8;
+
+    // pixels per value unit
+    double scale = m_viewLength / m_valueSpan;
+
+    // the nice number (1, 2 or 5 times a power of 10) not less than the space
+    double step = extent / scale;
+    double magnitude = pow(10.0, floor(log10(step)));
+    double mantissa = step / magnitude;
+
+    int nice = (mantissa <= 1) ? 1 : (mantissa <= 2) ? 2 : (mantissa <= 5) ? 5 : 10;
+
+    major = nice * magnitude;
+    minor = major / ((nice == 2) ? 4 : 5);
+
+    // minor ticks should be distinguishable
+    if (minor * scale < 4)
+        minor = major / 2;
+
+    if (minor * scale < 4)
+        minor = 0;
+}
+
+void AxisBase::addDataTicks(double base, double step, qint64 first, qint64 last, bool major, const QFontMetrics &fm)
+{
+    // the ticks closer than 2 pixels are skipped without mapping them,
+    // so there are no more iterations than the pixels whatever the range is
+    double stepPixels = step * m_viewLength / m_valueSpan;
+    qint64 stride = (stepPixels >= 2) ? 1 : tickIndex(ceil(2 / stepPixels));
+
+    QVector<QLine> &ticks = major ? m_majorTicks : m_minorTicks;
+    ticks.reserve(ticks.size() + int(qMin<qint64>((last - first) / stride + 1, qint64(m_viewLength) + 2)));
+
+    QRect prevRect;
+
+    for (qint64 i = first; i <= last; i += stride)
+    {
+        double value = base + i * step;
+        int p_d = toView(value);
+
+        addTick(p_d, major);
+
+        if (!major)
+            continue;
+
+        // the text would overlap the previous one anyway
+        if (prevRect.isValid() &&
+            (m_orient == Qt::Vertical ? p_d >= prevRect.top() : p_d <= prevRect.right()))
+        {
+            m_culledLabels++;
+            continue;
+        }
+
+        addTickLabel(p_d, QString::number(value), fm, prevRect);
+    }
+}
+
+void AxisBase::calculateModelLabels()
+{
+    if (m_orient != Qt::Horizontal || !m_model)
+        return;
+
+    PlotterBase *plotter = (PlotterBase*)parent();
+    QRect rect(plotter->contentsRect());
+
+    int p_start, p_end;
+    calculatePoints(p_start, p_end);
+
+    int first, count;
+    visibleRange(m_model->columnCount(), first, count);
+    if (count <= 0)
+        return;
+
+    m_modelColumns = count;
+
+    int p_offs = (p_end - p_start) / count;
+    int p_line_d = p_start + p_offs;
+
+    m_majorTicks.reserve(count);
+    m_majorGrid.reserve(count);
+
+    QFontMetrics fm(m_font);
+    QRect prevRect;
+
+    for (int i = 0; i < count; i++)
+    {
+        double d = (double)i / (double)count;
+        int p_d = d * (p_end - p_start) + p_start + p_offs/2;
+
+        m_majorTicks.append(QLine(p_d, rect.height()-m_offset+0, p_d, rect.height()-m_offset+4));
+        m_majorGrid.append(QLine(p_line_d, rect.top(), p_line_d, rect.height()-m_offset));
+        p_line_d += p_offs;
+
+        // the text would overlap the previous one anyway
+        if (prevRect.isValid() && p_d <= prevRect.right())
+        {
+            m_culledLabels++;
+            continue;
+        }
+
+        QString text(m_model->headerData(first + i, m_orient).toString());
+        QRect textRect(fm.boundingRect(text));
+
+        int w = textRect.width() + 4;
+        QRect drawRect(p_d - w/2, rect.height()-m_offset+3, w, m_offset);
+
+        // skip paining the text
+        if (prevRect.isValid() && prevRect.intersects(drawRect))
+        {
+            m_culledLabels++;
+            continue;
+        }
+        prevRect = drawRect;
+
+        addLabel(drawRect, text, Qt::AlignCenter);
+    }
+}
+
+/// Calendar unit of the ticks of \b AxisTime axis.
+enum TimeUnit { Milliseconds, Seconds, Minutes, Hours, Days, Months, Years };
+
+/// Step between the major (and the minor) ticks of \b AxisTime axis.
+struct TimeStep
+{
+    TimeUnit unit;
+    int count;
+    TimeUnit minorUnit;
+    /// 0 if there are no minor ticks
+    int minorCount;
+    /// format of the labels (see QDateTime::toString())
+    const char *format;
+};
+
+// ordered by the length
+static const TimeStep timeSteps[] =
+{
+    { Milliseconds, 1, Milliseconds, 0, "hh:mm:ss.zzz" },
+    { Milliseconds, 2, Milliseconds, 1, "hh:mm:ss.zzz" },
+    { Milliseconds, 5, Milliseconds, 1, "hh:mm:ss.zzz" },
+    { Milliseconds, 10, Milliseconds, 2, "hh:mm:ss.zzz" },
+    { Milliseconds, 20, Milliseconds, 5, "hh:mm:ss.zzz" },
+    { Milliseconds, 50, Milliseconds, 10, "hh:mm:ss.zzz" },
+    { Milliseconds, 100, Milliseconds, 20, "hh:mm:ss.zzz" },
+    { Milliseconds, 200, Milliseconds, 50, "hh:mm:ss.zzz" },
+    { Milliseconds, 500, Milliseconds, 100, "hh:mm:ss.zzz" },
+    { Seconds, 1, Milliseconds, 200, "hh:mm:ss" },
+    { Seconds, 2, Milliseconds, 500, "hh:mm:ss" },
+    { Seconds, 5, Seconds, 1, "hh:mm:ss" },
+    { Seconds, 10, Seconds, 2, "hh:mm:ss" },
+    { Seconds, 15, Seconds, 5, "hh:mm:ss" },
+    { Seconds, 30, Seconds, 5, "hh:mm:ss" },
+    { Minutes, 1, Seconds, 15, "hh:mm" },
+    { Minutes, 2, Seconds, 30, "hh:mm" },
+    { Minutes, 5, Minutes, 1, "hh:mm" },
+    { Minutes, 10, Minutes, 2, "hh:mm" },
+    { Minutes, 15, Minutes, 5, "hh:mm" },
+    { Minutes, 30, Minutes, 5, "hh:mm" },
+    { Hours, 1, Minutes, 15, "hh:mm" },
+    { Hours, 2, Minutes, 30, "hh:mm" },
+    { Hours, 3, Hours, 1, "hh:mm" },
+    { Hours, 6, Hours, 1, "hh:mm" },
+    { Hours, 12, Hours, 3, "hh:mm" },
+    { Days, 1, Hours, 6, "d MMM" },
+    { Days, 2, Hours, 12, "d MMM" },
+    { Days, 7, Days, 1, "d MMM" },
+    { Months, 1, Days, 1, "MMM yyyy" },
+    { Months, 2, Months, 1, "MMM yyyy" },
+    { Months, 3, Months, 1, "MMM yyyy" },
+    { Months, 6, Months, 1, "MMM yyyy" },
+    { Years, 1, Months, 3, "yyyy" },
+    { Years, 2, Years, 1, "yyyy" },
+    { Years, 5, Years, 1, "yyyy" },
+    { Years, 10, Years, 2, "yyyy" },
+    { Years, 20, Years, 5, "yyyy" },
+    { Years, 50, Years, 10, "yyyy" },
+    { Years, 100, Years, 20, "yyyy" },
+    { Years, 200, Years, 50, "yyyy" },
+    { Years, 500, Years, 100, "yyyy" },
+    { Years, 1000, Years, 200, "yyyy" }
+};
+
+static const int timeStepCount = sizeof(timeSteps) / sizeof(TimeStep);
+
+/// Returns approximate length of \a count \a units in milliseconds.
+static double timeLength(TimeUnit unit, int count)
+{
+    static const double msecs[] = { 1, 1000, 60000, 3600000, 86400000, 2629746000.0, 31556952000.0 };
+
+    return msecs[unit] * count;
+}
+
+/// Returns \a a divided by positive \a b rounded towards negative infinity.
+static qint64 floorDiv(qint64 a, qint64 b)
+{
+    return (a >= 0) ? a / b : -((b - 1 - a) / b);
+}
+
+/**
+    Generates ticks of \b AxisTime axis starting at the given time,
+    so only the visible ticks are calculated.
+*/
+class TimeTicks
+{
+public:
+    TimeTicks(TimeUnit unit, int count, Qt::TimeSpec spec) :
+        m_unit(unit),
+        m_count(count),
+        m_spec(spec),
+        m_tick(0),
+        m_wall(0)
+    {
+        m_step = qint64(timeLength(unit, count));
+    }
+
+    /// Returns the first tick at or after \a from.
+    qint64 first(qint64 from)
+    {
+        QDateTime local(QDateTime::fromMSecsSinceEpoch(from).toTimeSpec(m_spec));
+
+        if (m_unit < Days)
+        {
+            // the steps shorter than a day are aligned to the wall clock, i.e. the local time as if it were UTC
+            qint64 offset = QDateTime(local.date(), local.time(), Qt::UTC).toMSecsSinceEpoch() - from;
+
+            m_wall = -floorDiv(-(from + offset), m_step) * m_step;
+            m_tick = m_wall - offset;
+
+            if (m_unit == Hours)
+            {
+                m_tick = fromWallClock(m_wall);
+
+                if (m_tick < from)
+                    next();
+            }
+
+            return m_tick;
+        }
+
+        // calendar units: the first one is aligned to the multiple of the count
+        QDate date(local.date());
+
+        switch (m_unit)
+        {
+            case Days:
+            {
+                // weeks start on Monday, i.e. 1970-01-05
+                qint64 days = date.toJulianDay() - QDate(1970, 1, 5).toJulianDay();
+                date = date.addDays(-int(days - floorDiv(days, m_count) * m_count));
+                break;
+            }
+
+            case Months:
+            {
+                qint64 months = floorDiv(date.year() * 12 + date.month() - 1, m_count) * m_count;
+                date = QDate(int(floorDiv(months, 12)), int(months - floorDiv(months, 12) * 12) + 1, 1);
+                break;
+            }
+
+            default:
+            {
+                date = QDate(int(floorDiv(date.year(), m_count) * m_count), 1, 1);
+                break;
+            }
+        }
+
+        m_date = date;
+        m_tick = toMSecs(m_date);
+
+        while (m_tick < from)
+            next();
+
+        return m_tick;
+    }
+
+    /// Returns the tick following the last returned one.
+    qint64 next()
+    {
+        switch (m_unit)
+        {
+            case Days:
+                m_date = m_date.addDays(m_count);
+                break;
+
+            case Months:
+                m_date = m_date.addMonths(m_count);
+                break;
+
+            case Years:
+                m_date = m_date.addYears(m_count);
+                break;
+
+            case Hours:
+            {
+                // the offset from UTC changes with the daylight saving time, so the hours are stepped
+                // on the wall clock; the hours repeated by the change are not ticked twice
+                qint64 last = m_tick;
+
+                do
+                {
+                    m_wall += m_step;
+                    m_tick = fromWallClock(m_wall);
+                }
+                while (m_tick <= last);
+
+                return m_tick;
+            }
+
+            default:
+                m_tick += m_step;
+                return m_tick;
+        }
+
+        m_tick = toMSecs(m_date);
+
+        return m_tick;
+    }
+
+private:
+    /// Returns time of the start of \a date, or the maximal one if the date is out of range.
+    qint64 toMSecs(const QDate &date) const
+    {
+        if (!date.isValid())
+            return Q_INT64_C(0x7fffffffffffffff);
+
+        return QDateTime(date, QTime(0, 0), m_spec).toMSecsSinceEpoch();
+    }
+
+    /// Returns time of \a wall clock time (the local time as if it were UTC).
+    qint64 fromWallClock(qint64 wall) const
+    {
+        QDateTime time(QDateTime::fromMSecsSinceEpoch(wall).toUTC());
+
+        return QDateTime(time.date(), time.time(), m_spec).toMSecsSinceEpoch();
+    }
+
+    TimeUnit m_unit;
+    int m_count;
+    Qt::TimeSpec m_spec;
+
+    qint64 m_step;
+    qint64 m_tick;
+    /// wall clock time of the tick (steps shorter than a day)
+    qint64 m_wall;
+    QDate m_date;
+};
+
+
+void AxisBase::calculateTimeLabels()
+{
+    if (m_viewLength <= 0 || m_valueSpan <= 0)
+        return;
+
+    QFontMetrics fm(m_font);
+
+    // pixels per millisecond
+    double scale = m_viewLength / m_valueSpan;
+
+    // the shortest step the labels of which do not overlap
+    QDateTime sample(QDate(2000, 12, 28), QTime(23, 59, 59, 999));
+
+    int step = 0;
+    for (; step < timeStepCount - 1; step++)
+    {
+        const TimeStep &ts = timeSteps[step];
+
+        int extent = (m_orient == Qt::Vertical) ?
+                    fm.height() + 4 :
+                    fm.width(sample.toString(QLatin1String(ts.format))) + 8;
+
+        if (timeLength(ts.unit, ts.count) * scale >= extent)
+            break;
+    }
+
+    const TimeStep &ts = timeSteps[step];
+
+    qint64 start = qint64(ceil(m_min));
+    qint64 end = qint64(floor(m_max));
+
+    // no more ticks than the pixels, whatever the range is
+    int maxTicks = int(m_viewLength) + 2;
+
+    if (ts.minorCount > 0 && timeLength(ts.minorUnit, ts.minorCount) * scale >= 3)
+    {
+        TimeTicks ticks(ts.minorUnit, ts.minorCount, m_timeSpec);
+
+        m_minorTicks.reserve(qMin(maxTicks, int((end - start) / timeLength(ts.minorUnit, ts.minorCount)) + 2));
+        m_minorGrid.reserve(m_minorTicks.capacity());
+
+        int n = 0;
+        for (qint64 t = ticks.first(start); t <= end && n < maxTicks; t = ticks.next(), n++)
+            addTick(toView(t), false);
+    }
+
+    TimeTicks ticks(ts.unit, ts.count, m_timeSpec);
+    QString format(QLatin1String(ts.format));
+
+    m_majorTicks.reserve(qMin(maxTicks, int((end - start) / timeLength(ts.unit, ts.count)) + 2));
+    m_majorGrid.reserve(m_majorTicks.capacity());
+
+    QRect prevRect;
+
+    int n = 0;
+    for (qint64 t = ticks.first(start); t <= end && n < maxTicks; t = ticks.next(), n++)
+    {
+        int p_d = toView(t);
+
+        addTick(p_d, true);
+
+        QDateTime time(QDateTime::fromMSecsSinceEpoch(t).toTimeSpec(m_timeSpec));
+        addTickLabel(p_d, time.toString(format), fm, prevRect);
+    }
+}
+
+void AxisBase::addTick(int pos, bool major)
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+    QRect rect(plotter->contentsRect());
+
+    // major ticks are 5 pixels long, minor ones 3 pixels
+    int size = major ? 2 : 1;
+
+    QVector<QLine> &ticks = major ? m_majorTicks : m_minorTicks;
+    QVector<QLine> &grid = major ? m_majorGrid : m_minorGrid;
+
+    if (m_orient == Qt::Vertical)
+    {
+        ticks.append(QLine(m_offset+2-size, pos, m_offset+2+size, pos));
+        grid.append(QLine(m_offset+2, pos, rect.right(), pos));
+    }
+    else
+    {
+        ticks.append(QLine(pos, rect.height()-m_offset+2-size, pos, rect.height()-m_offset+2+size));
+        grid.append(QLine(pos, rect.top(), pos, rect.height()-m_offset));
+    }
+}
+
+void AxisBase::addTickLabel(int pos, const QString &text, const QFontMetrics &fm, QRect &prevRect)
+{
+    PlotterBase *plotter = (PlotterBase*)parent();
+    QRect rect(plotter->contentsRect());
+
+    QRect textRect(fm.boundingRect(text));
+
+    QRect drawRect;
+    int flags;
+
+    if (m_orient == Qt::Vertical)
+    {
+        int h = textRect.height();
+        drawRect = QRect(0, pos - h/2, m_offset, h);
+        flags = Qt::AlignRight | Qt::AlignVCenter;
+    }
+    else
+    {
+        int w = textRect.width();
+        drawRect = QRect(pos - w/2, rect.height()-m_offset+3, w, m_offset);
+        flags = Qt::AlignCenter;
+    }
+
+    // skip paining the text
+    if (prevRect.isValid() && prevRect.intersects(drawRect))
+    {
+        m_culledLabels++;
+        return;
+    }
+    prevRect = drawRect;
+
+    addLabel(drawRect, text, flags);
+}
+
+void AxisBase::addLabel(const QRect &rect, const QString &text, int flags)
+{
+    Label label;
+    label.rect = rect;
+    label.text = text;
+
+    prepareLabel(label);
+
+    // aligned within the rectangle
+    QSizeF size(label.staticText.size());
+
+    double x = (flags & Qt::AlignRight) ?
+                rect.left() + rect.width() - size.width() :
+                rect.left() + (rect.width() - size.width()) / 2;
+
+    double y = rect.top() + (rect.height() - size.height()) / 2;
+
+    label.pos = QPointF(x, y);
+
+    m_labels.append(label);
+}
+
+void AxisBase::prepareLabel(Label &label) const
+{
+    // setText() detaches the shared layout
+    label.staticText.setText(label.text);
+    label.staticText.setTextFormat(Qt::PlainText);
+    label.staticText.prepare(QTransform(), m_font);
+}
+
+void AxisBase::copyState(const AxisBase &other)
+{
+    m_min = other.m_min;
+    m_max = other.m_max;
+    m_minor = other.m_minor;
+    m_major = other.m_major;
+    m_autoTicks = other.m_autoTicks;
+    m_offset = other.m_offset;
+
+    m_viewportFirst = other.m_viewportFirst;
+    m_viewportSpan = other.m_viewportSpan;
+
+    m_font = other.m_font;
+    m_pen = other.m_pen;
+    m_minorPen = other.m_minorPen;
+    m_majorPen = other.m_majorPen;
+    m_minorGridPen = other.m_minorGridPen;
+    m_majorGridPen = other.m_majorGridPen;
+    m_textColor = other.m_textColor;
+
+    m_type = other.m_type;
+    m_timeSpec = other.m_timeSpec;
+
+    // the model is read only if the copy is laid out for another size in GUI thread
+    m_model = other.m_model;
+    m_modelColumns = other.m_modelColumns;
+    m_labels = other.m_labels;
+    m_culledLabels = other.m_culledLabels;
+
+    m_minorTicks = other.m_minorTicks;
+    m_minorGrid = other.m_minorGrid;
+    m_majorTicks = other.m_majorTicks;
+    m_majorGrid = other.m_majorGrid;
+
+    // the copy is painted by another thread
+    for (int i = 0; i < m_labels.count(); i++)
+        prepareLabel(m_labels[i]);
+
+    m_labelsSize = other.m_labelsSize;
+    m_labelsValid = other.m_labelsValid;
+
+    m_mappingValid = false;
+}
+
+
+} // namespace
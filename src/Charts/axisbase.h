@@ -1,103 +1,238 @@
-#ifndef AXISBASE_H
-#define AXISBASE_H
-
-
-#include "plotterbase.h"
-
-
-namespace QSint
-{
-
-
-class PlotterBase;
-
-
-/**
-    \brief Class representing single vertical or horizontal plotter axis.
-    \since 0.2.1
-
-    Class provides basic axis painting and calculations.
-*/
-
-class AxisBase : public QObject
-{
-    Q_OBJECT
-public:
-    explicit AxisBase(Qt::Orientation orient, PlotterBase *parent);
-
-
-    enum AxisType { AxisData, AxisTime, AxisModel };
-
-    void setType(AxisType type);
-    inline AxisType type() const { return m_type; }
-
-
-    void setRanges(double min, double max);
-    inline double rangeMininum() const { return m_min; }
-    inline double rangeMaximum() const { return m_max; }
-
-    void setTicks(double minor, double major);
-    inline double minorTicks() const { return m_minor; }
-    inline double majorTicks() const { return m_major; }
-
-    void setOffset(int offset);
-    inline int offset() const { return m_offset; }
-
-
-    void setFont(const QFont &font);
-    inline const QFont& font() const { return m_font; }
-
-    void setTextColor(const QColor &color);
-    inline const QColor& textColor() const { return m_textColor; }
-
-    void setPen(const QPen &pen);
-    inline const QPen& pen() const { return m_pen; }
-
-    void setMinorTicksPen(const QPen &pen);
-    inline const QPen& minorTicksPen() const { return m_minorPen; }
-
-    void setMajorTicksPen(const QPen &pen);
-    inline const QPen& majorTicksPen() const { return m_majorPen; }
-
-    void setMinorGridPen(const QPen &pen);
-    inline const QPen& minorGridPen() const { return m_minorGridPen; }
-
-    void setMajorGridPen(const QPen &pen);
-    inline const QPen& majorGridPen() const { return m_majorGridPen; }
-
-
-    void setModel(QAbstractItemModel *model);
-    inline QAbstractItemModel* model() const { return m_model; }
-
-
-    virtual void calculatePoints(int &p_start, int &p_end);
-
-    virtual int toView(double value);
-
-
-    virtual void draw(QPainter &p);
-
-protected:
-    virtual void drawAxisData(QPainter &p);
-    virtual void drawAxisModel(QPainter &p);
-
-    Qt::Orientation m_orient;
-
-    QAbstractItemModel *m_model;
-
-    double m_min, m_max;
-    double m_minor, m_major;
-    int m_offset;
-
-    QFont m_font;
-
-    QPen m_pen, m_minorPen, m_majorPen, m_minorGridPen, m_majorGridPen;
-    QColor m_textColor;
-
-    AxisType m_type;
-};
-
-
-} // namespace
-
-#endif // AXISBASE_H
+#ifndef AXISBASE_H
+#define AXISBASE_H
+
+
+#include <QStaticText>
+
+#include "plotterbase.h"
+
+
+namespace QSint
+{
+
+
+class PlotterBase;
+
+
+/**
+    \brief Class representing single vertical or horizontal plotter axis.
+    \since 0.2.1
+
+    Class provides basic axis painting and calculations.
+
+    Values of \b AxisTime axis are milliseconds since the epoch (1970-01-01T00:00:00 UTC).
+    Its ticks are placed on the calendar units (milliseconds to years) chosen for the range
+    and the length of the axis, so minorTicks() and majorTicks() are not used.
+*/
+
+class AxisBase : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AxisBase(Qt::Orientation orient, PlotterBase *parent);
+
+
+    enum AxisType { AxisData, AxisTime, AxisModel };
+
+    void setType(AxisType type);
+    inline AxisType type() const { return m_type; }
+
+
+    void setRanges(double min, double max);
+    inline double rangeMininum() const { return m_min; }
+    inline double rangeMaximum() const { return m_max; }
+
+    void setTicks(double minor, double major);
+    inline double minorTicks() const { return m_minor; }
+    inline double majorTicks() const { return m_major; }
+
+    /** Enables (\a set=true) or disables (\a set=false, the default) automatic ticks of \b AxisData axis.
+        The major ticks are placed on the nice numbers (1, 2 or 5 times a power of 10) chosen
+        so their labels fit the length of the axis; minorTicks() and majorTicks() are not used then.
+        \since 0.2.3
+    */
+    void setAutoTicks(bool set);
+    /// Returns true if automatic ticks are enabled. \sa setAutoTicks()
+    inline bool autoTicks() const { return m_autoTicks; }
+
+    /** Sets time specification the ticks and the labels of \b AxisTime axis
+        are calculated in to \a spec. Default is Qt::LocalTime.
+        \since 0.2.3
+    */
+    void setTimeSpec(Qt::TimeSpec spec);
+    /// Retrieves time specification of \b AxisTime axis. \sa setTimeSpec()
+    inline Qt::TimeSpec timeSpec() const { return m_timeSpec; }
+
+    void setOffset(int offset);
+    inline int offset() const { return m_offset; }
+
+    /** Sets visible range of the model columns to \a span columns starting at \a first.
+        0 \a span (the default) means to show all the columns.
+        Valid for \b AxisModel axis type.
+        \since 0.2.3
+    */
+    void setViewport(int first, int span);
+    /// Retrieves first visible model column. \sa setViewport()
+    inline int viewportFirst() const { return m_viewportFirst; }
+    /// Retrieves number of the visible model columns, or 0 if all of them are shown. \sa setViewport()
+    inline int viewportSpan() const { return m_viewportSpan; }
+
+    /// Fits the viewport into \a count model columns and retrieves the resulting
+    /// first visible column \a first and number of the visible columns \a span.
+    void visibleRange(int count, int &first, int &span) const;
+
+
+    void setFont(const QFont &font);
+    inline const QFont& font() const { return m_font; }
+
+    void setTextColor(const QColor &color);
+    inline const QColor& textColor() const { return m_textColor; }
+
+    void setPen(const QPen &pen);
+    inline const QPen& pen() const { return m_pen; }
+
+    void setMinorTicksPen(const QPen &pen);
+    inline const QPen& minorTicksPen() const { return m_minorPen; }
+
+    void setMajorTicksPen(const QPen &pen);
+    inline const QPen& majorTicksPen() const { return m_majorPen; }
+
+    void setMinorGridPen(const QPen &pen);
+    inline const QPen& minorGridPen() const { return m_minorGridPen; }
+
+    void setMajorGridPen(const QPen &pen);
+    inline const QPen& majorGridPen() const { return m_majorGridPen; }
+
+
+    void setModel(QAbstractItemModel *model);
+    inline QAbstractItemModel* model() const { return m_model; }
+
+
+    virtual void calculatePoints(int &p_start, int &p_end);
+
+    /// Maps \a value to the view coordinate.
+    virtual int toView(double value);
+
+    /** Maps \a count values starting at \a values to the view coordinates and stores them into \a points.
+        Result is the same as calling default implementation of toView() for each of the values,
+        but the conversion is performed in one pass (vectorized if SSE2/AVX is available).
+    */
+    void mapToView(const double *values, int *points, int count);
+
+    /// Invalidates cached mapping of the values to the view coordinates, and the cached ticks and labels.
+    /// It is done automatically when the ranges, the ticks, the font, the offset or the plotter size have been changed.
+    void invalidate();
+
+
+    virtual void draw(QPainter &p);
+
+    /** Recalculates the mapping of the values to the view coordinates, positions of the ticks
+        and the grid lines, and lays out the labels (values or model header texts) if they are
+        out of date (see invalidate()).
+        Called by the parent plotter when its layout is updated, so painting of the axis
+        does not access the model and draws the cached lines and texts only.
+        \since 0.2.3
+    */
+    virtual void calculateLabels();
+
+    /// Copies appearance, ranges, viewport and the label placement of \a other axis.
+    /// \since 0.2.3
+    void copyState(const AxisBase &other);
+
+    /** Sets the range to \a min and \a max as setRanges() does, but does not schedule update
+        of the parent plotter, since it is called by the plotter while laying out the frame.
+        Returns true if the range has been changed.
+        \since 0.2.3
+    */
+    bool adjustRanges(double min, double max);
+
+Q_SIGNALS:
+    /// Emitted when the viewport has been changed to \a span columns starting at \a first.
+    void viewportChanged(int first, int span);
+
+protected:
+    /// Invalidates cached content of the parent plotter.
+    void scheduleUpdate();
+
+    /// Recalculates mapping of the values to the view coordinates if it is not valid.
+    void ensureMapping();
+
+    virtual void drawAxisData(QPainter &p);
+    virtual void drawAxisModel(QPainter &p);
+
+    /// Draws the cached ticks and grid lines.
+    void drawTicks(QPainter &p);
+    /// Draws the cached labels.
+    void drawLabels(QPainter &p);
+
+    /// Places the ticks and the value labels of \b AxisData axis.
+    void calculateDataLabels();
+    /// Calculates \a minor and \a major steps of the automatic ticks (see setAutoTicks()).
+    void calculateAutoTicks(const QFontMetrics &fm, double &minor, double &major) const;
+    /// Appends minor or \a major ticks (and the labels) at \a base + i * \a step for \a i from \a first to \a last.
+    void addDataTicks(double base, double step, qint64 first, qint64 last, bool major, const QFontMetrics &fm);
+    /// Places the ticks and the model header labels of \b AxisModel axis.
+    void calculateModelLabels();
+    /// Places the ticks and the date/time labels of \b AxisTime axis.
+    void calculateTimeLabels();
+
+    /// Appends minor or \a major tick and grid line at \a pos of the view.
+    void addTick(int pos, bool major);
+    /// Appends label of \a text at the tick at \a pos unless it overlaps \a prevRect (the previous label).
+    void addTickLabel(int pos, const QString &text, const QFontMetrics &fm, QRect &prevRect);
+
+    Qt::Orientation m_orient;
+
+    QAbstractItemModel *m_model;
+
+    double m_min, m_max;
+    double m_minor, m_major;
+    bool m_autoTicks;
+    int m_offset;
+
+    int m_viewportFirst, m_viewportSpan;
+
+    /// Label placed on the axis.
+    struct Label
+    {
+        QRect rect;
+        QString text;
+        /// text laid out for the font of the axis, drawn at \a pos
+        QStaticText staticText;
+        QPointF pos;
+    };
+
+    /// Appends label of \a text aligned within \a rect according to \a flags.
+    void addLabel(const QRect &rect, const QString &text, int flags);
+    /// Lays out the text of \a label.
+    void prepareLabel(Label &label) const;
+
+    // placement of the ticks and the labels: see calculateLabels()
+    int m_modelColumns;
+    QVector<Label> m_labels;
+    /// number of the labels skipped since they would overlap
+    int m_culledLabels;
+    QVector<QLine> m_minorTicks, m_minorGrid;
+    QVector<QLine> m_majorTicks, m_majorGrid;
+    bool m_labelsValid;
+    QSize m_labelsSize;
+
+    QFont m_font;
+
+    QPen m_pen, m_minorPen, m_majorPen, m_minorGridPen, m_majorGridPen;
+    QColor m_textColor;
+
+    AxisType m_type;
+    Qt::TimeSpec m_timeSpec;
+
+    // cached mapping: see ensureMapping()
+    bool m_mappingValid;
+    QSize m_mappingSize;
+    double m_viewStart, m_viewEnd, m_viewLength;
+    double m_valueSpan;
+};
+
+
+} // namespace
+
+#endif // AXISBASE_H
@@ -1,523 +1,1370 @@
-#include "barchartplotter.h"
-#include "axisbase.h"
-
-
-namespace QSint
-{
-
-
-BarChartPlotter::BarChartPlotter(QWidget *parent) :
-    PlotterBase(parent)
-{
-    m_axisX = new AxisBase(Qt::Horizontal, this);
-    m_axisY = new AxisBase(Qt::Vertical, this);
-
-    setBarType(Stacked);
-
-    m_axisX->setType(AxisBase::AxisModel);
-
-    setBarSize(-INT_MAX, INT_MAX);
-    setBarScale(0.5);
-    setBarOpacity(1.0);
-
-    setZeroLinePen(QPen(Qt::white));
-}
-
-
-void BarChartPlotter::setBarType(BarChartType type)
-{
-    m_type = type;
-}
-
-
-void BarChartPlotter::setBarSize(int min, int max)
-{
-    m_barsize_min = qMax(min, 0);
-    m_barsize_max = qMax(min, max);
-}
-
-
-void BarChartPlotter::setBarScale(double scale)
-{
-    if (scale < 0.1)
-        m_scale = 0.1;
-    else
-        m_scale = qMin(scale, 1.0);
-}
-
-
-void BarChartPlotter::setBarOpacity(double value)
-{
-    if (value < 0.0)
-        m_opacity = 0;
-    else
-        m_opacity = qMin(value, 1.0);
-}
-
-
-void BarChartPlotter::setZeroLinePen(const QPen &pen)
-{
-    m_zeroLinePen = pen;
-}
-
-
-void BarChartPlotter::drawContent(QPainter &p)
-{
-    if (!m_model || !m_axisX || !m_axisY)
-        return;
-
-    int p_start, p_end;
-    m_axisX->calculatePoints(p_start, p_end);
-
-    // draw zero line
-    int p_y = m_axisY->toView(0);
-
-    p.setPen(m_zeroLinePen);
-    p.drawLine(p_start, p_y, p_end, p_y);
-
-    int count = m_model->columnCount();
-    if (!count)
-        return;
-
-    int row_count = m_model->rowCount();
-    if (!row_count)
-        return;
-
-    int p_offs = double(p_end - p_start) / count;
-
-    int bar_size = p_offs * m_scale;
-
-    if (bar_size > m_barsize_max)
-        bar_size = qMin(m_barsize_max, p_offs);
-    else if (bar_size < m_barsize_min)
-        bar_size = qMin(m_barsize_min, p_offs);
-
-
-    switch (m_type)
-    {
-    case Stacked:
-        StackedBarPainter::draw(this, p, count, row_count, p_start, p_offs, bar_size);
-        break;
-
-    case Columns:
-        ColumnBarPainter::draw(this, p, count, row_count, p_start, p_offs, bar_size);
-        break;
-
-    case Trend:
-        TrendPainter::draw(this, p, count, row_count, p_start, p_offs, bar_size);
-        break;
-
-    } // switch
-}
-
-
-void BarChartPlotter::drawSegment(QPainter &p, QRect rect,
-                                  const QModelIndex &index, double /*value*/,
-                                  bool isHighlighted) const
-{
-    if (isHighlighted)
-    {
-        p.setPen(highlightPen());
-        p.setBrush(highlightBrush());
-    }
-    else
-    {
-        QVariant v_brush(model()->data(index, Qt::BackgroundRole));
-        if (v_brush.isValid())
-            p.setBrush(qvariant_cast<QBrush>(v_brush));
-        else
-            p.setBrush(qvariant_cast<QBrush>(model()->headerData(index.row(), Qt::Vertical, Qt::BackgroundRole)));
-
-        p.setPen(itemPen());
-    }
-
-    if (barType() == Trend)
-    {
-        p.drawEllipse(rect.topLeft(), 3, 3);
-        return;
-    }
-
-    p.drawRect(rect);
-}
-
-
-void BarChartPlotter::drawValue(QPainter &p, QRect rect,
-                                  const QModelIndex &index, double value,
-                                  bool isHighlighted) const
-{
-    int flags = Qt::AlignCenter;
-
-    QString text = formattedValue(value);
-
-    QRect textRect(p.fontMetrics().boundingRect(text));
-
-/*    switch (barType())
-    {
-        case Columns:
-            if (value < 0)
-            {
-                flags = Qt::AlignHCenter | Qt::AlignTop;
-                rect.setTop(rect.bottom() + 4);
-                rect.setHeight(textRect.height());
-            }
-            else
-            {
-                flags = Qt::AlignHCenter | Qt::AlignBottom;
-                rect.setTop(rect.top() - textRect.height() - 4);
-                rect.setHeight(textRect.height());
-            }
-
-            if (rect.width() < textRect.width() + 4)
-                rect.setWidth(textRect.width() + 4);
-
-            if (isHighlighted)
-            {
-                flags = Qt::AlignCenter;
-                QRect frameRect = drawHighlightedValueFrame(p, rect, textRect);
-                drawValueText(p, frameRect, flags, true, index, text);
-            }
-            else
-                drawValueText(p, rect, flags, isHighlighted, index, text);
-
-            break;
-
-        case Stacked:
-            if (textRect.height() > rect.height() || textRect.width() > rect.width())
-            {
-                if (isHighlighted)
-                {
-                    QRect frameRect = drawHighlightedValueFrame(p, rect, textRect);
-                    drawValueText(p, frameRect, flags, true, index, text);
-                }
-            }
-            else
-            {
-                drawValueText(p, rect, flags, isHighlighted, index, text);
-            }
-
-            break;
-
-        case Trend:*/
-            int rectWidth = rect.width();
-            rect.setSize(textRect.size());
-            rect.moveLeft(rect.left() + (rectWidth - textRect.width()) /2);
-
-            rect.moveTop(rect.top() - rect.height()/2);
-            if (value < 0)
-                rect.moveTop(rect.top() + rect.height());
-            else
-                rect.moveTop(rect.top() - rect.height());
-
-            if (rect.width() < textRect.width() + 4)
-            {
-                rect.setWidth(textRect.width() + 4);
-                rect.moveLeft(rect.left() - 2);
-            }
-
-            if (isHighlighted)
-            {
-                drawHighlightedValueFrame(p, rect, textRect);
-            }
-
-            drawValueText(p, rect, flags, isHighlighted, index, text);
-
-/*            break;
-    }*/
-
-}
-
-
-void BarChartPlotter::drawValueText(QPainter &p, const QRect &rect, int flags, bool isHighlighted, const QModelIndex &index, const QString &text) const
-{
-
-    if (isHighlighted)
-    {
-        p.setPen(QPen(highlightTextColor()));
-    }
-    else
-    {
-        QVariant v_pen(model()->data(index, Qt::ForegroundRole));
-        if (v_pen.isValid())
-            p.setPen(qvariant_cast<QColor>(v_pen));
-        else
-            p.setPen(qvariant_cast<QColor>(model()->headerData(index.row(), Qt::Vertical, Qt::ForegroundRole)));
-    }
-
-    p.drawText(rect, flags, text);
-}
-
-
-QRect BarChartPlotter::drawHighlightedValueFrame(QPainter &p, const QRect &rect, const QRect &textRect) const
-{    
-    QRect backRect(textRect.adjusted(-3,-3,3,3));
-    backRect.moveLeft(rect.center().x() - backRect.width()/2);
-    backRect.moveTop(rect.center().y() - backRect.height()/2);
-
-    p.setPen(highlightPen());
-    p.setBrush(highlightBrush());
-    p.drawRect(backRect);
-
-    return backRect;
-}
-
-
-void BarChartPlotter::BarPainter::drawBarItem(QPainter &p, QRect rect,
-                                              const QPen &pen, const QBrush &brush,
-                                              const QModelIndex &/*index*/, double /*value*/)
-{
-    p.setPen(pen);
-    p.setBrush(brush);
-    p.drawRect(rect);
-}
-
-
-void BarChartPlotter::BarPainter::drawValueText(QPainter &p, QRect rect, int flags,
-                                                const QPen &pen, const QBrush &brush,
-                                                const QModelIndex &index, double /*value*/)
-{
-    p.setPen(pen);
-    p.setBrush(brush);
-    //p.drawText(rect, flags, QString::number(value));
-    p.drawText(rect, flags, index.data(Qt::DisplayRole).toString());
-}
-
-
-void BarChartPlotter::StackedBarPainter::draw(
-    BarChartPlotter *plotter,
-    QPainter &p,
-    int count,
-    int row_count,
-    int p_start,
-    int p_offs,
-    int bar_size)
-{
-    bool isHighlight = false;
-    double valueHl;
-    QModelIndex indexHl;
-    QRect rectHl;
-
-    for (int i = 0; i < count; i++)
-    {
-        int p_d = p_start + p_offs*i + (p_offs-bar_size)/2;
-
-        double acc_value = 0;
-        int p_y = plotter->axisY()->toView(0);
-
-        double neg_value = 0;
-        int p_ny = p_y;
-
-        p.setOpacity(plotter->barOpacity());
-
-        for (int j = 0; j < row_count; j++)
-        {
-            QRect itemRect;
-
-            const QModelIndex index(plotter->model()->index(j, i));
-            double value = plotter->model()->data(index, Qt::EditRole).toDouble();
-            if (value < 0)
-            {
-                neg_value += value;
-
-                int p_h = plotter->axisY()->toView(neg_value);
-
-                itemRect = QRect(p_d, p_ny, bar_size, p_h-p_ny);
-
-                p_ny = p_h;
-            }
-            else
-            {
-                acc_value += value;
-
-                int p_h = plotter->axisY()->toView(acc_value);
-
-                itemRect = QRect(p_d, p_h, bar_size, p_y-p_h);
-
-                p_y = p_h;
-            }
-
-            // check for highlight
-            if (!isHighlight && !plotter->mousePos().isNull() && itemRect.contains(plotter->mousePos()))
-            {
-                isHighlight = true;
-                valueHl = value;
-                indexHl = index;
-                rectHl = itemRect;
-            }
-            else
-            {
-                plotter->drawSegment(p, itemRect, index, value, false);
-                plotter->drawValue(p, itemRect, index, value, false);
-            }
-        }
-    }
-
-    if (isHighlight)
-    {
-        plotter->setIndexUnderMouse(indexHl);
-
-        plotter->drawSegment(p, rectHl, indexHl, valueHl, true);
-        plotter->drawValue(p, rectHl, indexHl, valueHl, true);
-    }
-    else
-        plotter->setIndexUnderMouse(QModelIndex());
-}
-
-
-void BarChartPlotter::ColumnBarPainter::draw(
-    BarChartPlotter *plotter,
-    QPainter &p,
-    int count,
-    int row_count,
-    int p_start,
-    int p_offs,
-    int bar_size)
-{
-    int single_bar_size = bar_size/row_count;
-    if (!single_bar_size)
-        return;
-
-    bool isHighlight = false;
-    double valueHl;
-    QModelIndex indexHl;
-    QRect rectHl;
-
-    for (int i = 0; i < count; i++)
-    {
-        int p_d = p_start + p_offs*i + (p_offs-bar_size)/2;
-
-        int p_y = plotter->axisY()->toView(0);
-
-        p.setOpacity(plotter->barOpacity());
-
-        for (int j = 0; j < row_count; j++)
-        {
-            const QModelIndex index(plotter->model()->index(j, i));
-            double value = plotter->model()->data(index, Qt::EditRole).toDouble();
-
-            int p_h = plotter->axisY()->toView(value);
-
-            QRect itemRect;
-
-            if (value < 0)
-            {
-                itemRect = QRect(p_d, p_y, single_bar_size, p_h-p_y);
-            }
-            else
-            {
-                itemRect = QRect(p_d, p_h, single_bar_size, p_y-p_h);
-            }
-
-            // check for highlight
-            if (!isHighlight && !plotter->mousePos().isNull() && itemRect.contains(plotter->mousePos()))
-            {
-                isHighlight = true;
-                valueHl = value;
-                indexHl = index;
-                rectHl = itemRect;
-            }
-            else
-            {
-                plotter->drawSegment(p, itemRect, index, value, false);
-                plotter->drawValue(p, itemRect, index, value, false);
-            }
-
-            p_d += single_bar_size;
-        }
-    }
-
-    if (isHighlight)
-    {
-        plotter->setIndexUnderMouse(indexHl);
-
-        plotter->drawSegment(p, rectHl, indexHl, valueHl, true);
-        plotter->drawValue(p, rectHl, indexHl, valueHl, true);
-    }
-    else
-        plotter->setIndexUnderMouse(QModelIndex());
-}
-
-
-void BarChartPlotter::TrendPainter::draw(
-    BarChartPlotter *plotter,
-    QPainter &p,
-    int count,
-    int row_count,
-    int p_start,
-    int p_offs,
-    int /*bar_size*/)
-{
-    bool isHighlight = false;
-    double valueHl;
-    QModelIndex indexHl;
-    QRect rectHl;
-
-    p.save();
-    p.setRenderHint(QPainter::Antialiasing);
-
-    p.setOpacity(plotter->barOpacity());
-
-    p.setFont(plotter->font());
-
-    for (int j = 0; j < row_count; j++)
-    {
-        QPen pen(qvariant_cast<QColor>(plotter->model()->headerData(j, Qt::Vertical, Qt::ForegroundRole)));
-        QBrush brush(qvariant_cast<QBrush>(plotter->model()->headerData(j, Qt::Vertical, Qt::BackgroundRole)));
-
-        QPolygon points;
-
-        for (int i = 0; i < count; i++)
-        {
-            const QModelIndex index(plotter->model()->index(j, i));
-            double value = plotter->model()->data(index, Qt::EditRole).toDouble();
-
-            int x = p_start + p_offs*i + p_offs/2;
-            int y = plotter->axisY()->toView(value);
-            QRect itemRect(x,y,1,1);
-
-            points.append(itemRect.topLeft());
-
-            // check for higlight
-            if (!isHighlight && !plotter->mousePos().isNull() && QRect(x-3, y-3, 7, 7).contains(plotter->mousePos()))
-            {
-                isHighlight = true;
-                valueHl = value;
-                indexHl = index;
-                rectHl = itemRect;
-            }
-            else
-                plotter->drawValue(p, itemRect, index, value, false);
-        }
-
-        p.setPen(QPen(brush, 2));
-        p.drawPolyline(points);
-
-        //p.setPen(pen);
-        //p.setBrush(brush);
-        for (int i = 0; i < count; i++)
-        {
-            const QModelIndex index(plotter->model()->index(j, i));
-            if (index != indexHl)
-            {
-                double value = plotter->model()->data(index, Qt::EditRole).toDouble();
-                plotter->drawSegment(p, QRect(points.at(i), QSize(1,1)), index, value, false);
-            }
-
-            //p.drawEllipse(points.at(i), 3, 3);
-        }
-    }
-
-    if (isHighlight)
-    {
-        plotter->setIndexUnderMouse(indexHl);
-
-        plotter->drawSegment(p, rectHl, indexHl, valueHl, true);
-        plotter->drawValue(p, rectHl, indexHl, valueHl, true);
-    }
-    else
-        plotter->setIndexUnderMouse(QModelIndex());
-
-    p.restore();
-}
-
-
-} // namespace
+#include <qmath.h>
+#include <typeinfo>
+#include <algorithm>
+
+#include "barchartplotter.h"
+#include "axisbase.h"
+
+
+namespace QSint
+{
+
+
+BarChartPlotter::BarChartPlotter(QWidget *parent) :
+    PlotterBase(parent)
+{
+    m_axisX = new AxisBase(Qt::Horizontal, this);
+    m_axisY = new AxisBase(Qt::Vertical, this);
+
+    setBarType(Stacked);
+
+    m_axisX->setType(AxisBase::AxisModel);
+
+    // own styles of the items are kept in the snapshot
+    m_data.setCellStylesEnabled(true);
+
+    setBarSize(-INT_MAX, INT_MAX);
+    setBarScale(0.5);
+    setBarOpacity(1.0);
+
+    setZeroLinePen(QPen(Qt::white));
+
+    setTrendMarkerSpacing(4);
+
+    m_autoRange = false;
+
+    m_customPainting = false;
+
+    m_navigation = false;
+    m_dragFirst = -1;
+
+    m_firstColumn = m_columnSpan = 0;
+}
+
+
+void BarChartPlotter::setBarType(BarChartType type)
+{
+    m_type = type;
+
+    // trends of many columns are reduced using min/max pyramid of the data
+    m_data.setPyramidEnabled(m_type == Trend);
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::setBarSize(int min, int max)
+{
+    m_barsize_min = qMax(min, 0);
+    m_barsize_max = qMax(min, max);
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::setBarScale(double scale)
+{
+    if (scale < 0.1)
+        m_scale = 0.1;
+    else
+        m_scale = qMin(scale, 1.0);
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::setBarOpacity(double value)
+{
+    if (value < 0.0)
+        m_opacity = 0;
+    else
+        m_opacity = qMin(value, 1.0);
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::setZeroLinePen(const QPen &pen)
+{
+    m_zeroLinePen = pen;
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::setTrendMarkerSpacing(int pixels)
+{
+    m_markerSpacing = qMax(0, pixels);
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::setAutoRange(bool on)
+{
+    m_autoRange = on;
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::setMouseNavigation(bool on)
+{
+    m_navigation = on;
+    m_dragFirst = -1;
+}
+
+
+void BarChartPlotter::setCustomItemPainting(bool on)
+{
+    m_customPainting = on;
+
+    scheduleUpdate();
+}
+
+
+void BarChartPlotter::calculateLayout()
+{
+    m_valueLabels.clear();
+    m_items.clear();
+    m_columnLeft.clear();
+    m_columnRight.clear();
+    m_trendLines.clear();
+    m_itemStyles.clear();
+    m_trendMarkers = true;
+    m_columnOffset = 0;
+    m_firstColumn = m_columnSpan = 0;
+
+    if (!m_model || !m_axisX || !m_axisY)
+        return;
+
+    int p_start, p_end;
+    m_axisX->calculatePoints(p_start, p_end);
+
+    // only the columns within the viewport are laid out
+    m_axisX->visibleRange(m_data.columnCount(), m_firstColumn, m_columnSpan);
+
+    // the items are mapped by Y axis
+    if (m_autoRange)
+        updateAutoRange();
+
+    int count = m_columnSpan;
+    if (!count)
+        return;
+
+    int row_count = m_data.rowCount();
+    if (!row_count)
+        return;
+
+    int p_offs = double(p_end - p_start) / count;
+
+    int bar_size = p_offs * m_scale;
+
+    if (bar_size > m_barsize_max)
+        bar_size = qMin(m_barsize_max, p_offs);
+    else if (bar_size < m_barsize_min)
+        bar_size = qMin(m_barsize_min, p_offs);
+
+    m_items.resize(count * row_count);
+
+    switch (m_type)
+    {
+    case Stacked:
+        StackedBarPainter::layout(this, count, row_count, p_start, p_offs, bar_size);
+        break;
+
+    case Columns:
+        ColumnBarPainter::layout(this, count, row_count, p_start, p_offs, bar_size);
+        break;
+
+    case Trend:
+        TrendPainter::layout(this, count, row_count, p_start, p_offs, bar_size);
+        break;
+
+    } // switch
+
+    if (m_items.isEmpty())
+        return;
+
+    // own styles of the items come from the snapshot; model indexes are taken only for the items
+    // passed to drawSegment() one by one (see BarItem), so painting does not access the model
+    bool indexed = (m_type == Trend && m_trendMarkers) || m_customPainting;
+
+    for (BarItem *item = m_items.begin(); item != m_items.end(); item++)
+    {
+        item->style = -1;
+
+        const ChartData::CellStyle *cell = m_data.cellStyle(item->row, item->column);
+        if (cell)
+        {
+            SeriesStyle style(seriesStyle(item->row));
+
+            if (cell->brush.isValid())
+                style.brush = qvariant_cast<QBrush>(cell->brush);
+
+            if (cell->textColor.isValid())
+                style.textPen = QPen(qvariant_cast<QColor>(cell->textColor));
+
+            item->style = m_itemStyles.count();
+            m_itemStyles.append(style);
+        }
+
+        if (indexed || item->style >= 0)
+            item->index = m_model->index(item->row, item->column);
+    }
+
+    // reduced trends have less items than the model
+    if (count == m_items.count() / row_count)
+        m_columnOffset = p_offs;
+    else
+        count = m_items.count() / row_count;
+
+    // columns are placed uniformly, so their extents are sorted by X
+    m_columnLeft.resize(count);
+    m_columnRight.resize(count);
+
+    const BarItem *item = m_items.constData();
+
+    for (int i = 0; i < count; i++)
+    {
+        int left = INT_MAX, right = -INT_MAX;
+
+        for (int j = 0; j < row_count; j++, item++)
+        {
+            if (item->hitRect.isEmpty())
+                continue;
+
+            left = qMin(left, item->hitRect.left());
+            right = qMax(right, item->hitRect.right());
+        }
+
+        m_columnLeft[i] = left;
+        m_columnRight[i] = (i > 0) ? qMax(right, m_columnRight[i-1]) : right;
+    }
+
+    calculateValueLabels();
+}
+
+
+/// Coarse map of the plotter area occupied by the value texts.
+class OccupancyGrid
+{
+public:
+    OccupancyGrid(const QRect &area, int cellSize) :
+        m_area(area),
+        m_cellSize(cellSize),
+        m_columns(area.width() / cellSize + 1),
+        m_cells(m_columns * (area.height() / cellSize + 1))
+    {
+    }
+
+    /// Returns true if none of the cells covered by \a rect (within the area) is occupied.
+    bool isFree(const QRect &rect) const
+    {
+        int x1, y1, x2, y2;
+        cells(rect, x1, y1, x2, y2);
+
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                if (m_cells.testBit(y * m_columns + x))
+                    return false;
+
+        return true;
+    }
+
+    /// Marks the cells covered by \a rect (within the area) as occupied.
+    void occupy(const QRect &rect)
+    {
+        int x1, y1, x2, y2;
+        cells(rect, x1, y1, x2, y2);
+
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                m_cells.setBit(y * m_columns + x);
+    }
+
+private:
+    void cells(const QRect &rect, int &x1, int &y1, int &x2, int &y2) const
+    {
+        x1 = (rect.left() - m_area.left()) / m_cellSize;
+        y1 = (rect.top() - m_area.top()) / m_cellSize;
+        x2 = (rect.right() - m_area.left()) / m_cellSize;
+        y2 = (rect.bottom() - m_area.top()) / m_cellSize;
+    }
+
+    QRect m_area;
+    int m_cellSize;
+    int m_columns;
+    QBitArray m_cells;
+};
+
+
+void BarChartPlotter::calculateValueLabels()
+{
+    m_valueLabels.clear();
+
+    // values of the trends are shown along with their markers only
+    int count = m_columnLeft.count();
+    if (!count || (m_type == Trend && !m_trendMarkers))
+        return;
+
+    const QFont &font = valueFont();
+    QFontMetrics fm(font);
+
+    // the columns are too dense to show even a single digit
+    int digitWidth = fm.width(QLatin1Char('0'));
+
+    int p_start, p_end;
+    m_axisX->calculatePoints(p_start, p_end);
+
+    if ((p_end - p_start) / count < digitWidth)
+        return;
+
+    QRect area(rect());
+    OccupancyGrid grid(area, 4);
+
+    // the skipped texts are formatted into the same buffer
+    QString text;
+
+    for (int i = 0; i < m_items.count(); i++)
+    {
+        const BarItem &item = m_items.at(i);
+
+        // size of the text is estimated, so the skipped ones are not laid out at all
+        formatValue(item.value, text);
+        QRect textRect(0, 0, text.length() * digitWidth, fm.height());
+
+        QRect place(valueRect(item.rect, textRect, item.value));
+        if (!area.contains(place) || !grid.isFree(place))
+            continue;
+
+        grid.occupy(place);
+
+        ValueLabel label;
+        label.item = i;
+        label.text.setText(QString(text.constData(), text.length()));
+        label.text.setTextFormat(Qt::PlainText);
+        label.text.prepare(QTransform(), font);
+
+        // centered as the text drawn by drawValue()
+        QSizeF size(label.text.size());
+        label.pos = QPointF(place.left() + (place.width() - size.width()) / 2,
+                            place.top() + (place.height() - size.height()) / 2);
+
+        m_valueLabels.append(label);
+    }
+}
+
+
+void BarChartPlotter::drawValueLabels(QPainter &p, int begin, int end) const
+{
+    // the first label of the range
+    int first = 0, last = m_valueLabels.count();
+    while (first < last)
+    {
+        int middle = (first + last) / 2;
+        if (m_valueLabels.at(middle).item < begin)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    p.setFont(valueFont());
+
+    int drawn = 0, laidOut = 0;
+
+    for (int i = first; i < m_valueLabels.count(); i++)
+    {
+        const ValueLabel &label = m_valueLabels.at(i);
+        if (label.item >= end)
+            break;
+
+        const BarItem &item = m_items.at(label.item);
+
+        laidOut++;
+
+        // the text is formatted and counted by drawValue()
+        if (m_customPainting)
+        {
+            drawValue(p, item.rect, item.index, item.value, false);
+            continue;
+        }
+
+        p.setPen(item.style >= 0 ? m_itemStyles.at(item.style).textPen : seriesStyle(item.row).textPen);
+        p.drawStaticText(label.pos, label.text);
+
+        drawn++;
+    }
+
+    countLabels(drawn, end - begin - laidOut);
+}
+
+
+void BarChartPlotter::drawContent(QPainter &p)
+{
+    if (!m_model || !m_axisX || !m_axisY)
+        return;
+
+    int p_start, p_end;
+    m_axisX->calculatePoints(p_start, p_end);
+
+    // draw zero line
+    int p_y = m_axisY->toView(0);
+
+    p.setPen(m_zeroLinePen);
+    p.drawLine(p_start, p_y, p_end, p_y);
+
+    int count = m_columnLeft.count();
+    if (!count)
+        return;
+
+    int row_count = m_items.count() / count;
+
+    int first = 0, last = count - 1;
+
+    // paint only the columns within the clipping area (and their value texts)
+    if (p.hasClipping())
+    {
+        QRect clip(p.clipRegion().boundingRect());
+        int margin = textMargin();
+
+        first = std::lower_bound(m_columnRight.constBegin(), m_columnRight.constEnd(), clip.left() - margin)
+                - m_columnRight.constBegin();
+
+        for (last = first; last < count; last++)
+        {
+            int left = m_columnLeft.at(last);
+            if (left != INT_MAX && left > clip.right() + margin)
+                break;
+        }
+
+        // neighbour columns are needed to connect the trend lines
+        first = qMax(0, first - 1);
+        last = qMin(count - 1, last);
+
+        if (first > last)
+            return;
+    }
+
+    switch (m_type)
+    {
+    case Stacked:
+        StackedBarPainter::draw(this, p, first, last, row_count);
+        break;
+
+    case Columns:
+        ColumnBarPainter::draw(this, p, first, last, row_count);
+        break;
+
+    case Trend:
+        TrendPainter::draw(this, p, first, last, row_count);
+        break;
+
+    } // switch
+}
+
+
+int BarChartPlotter::scrollDistance(int columns) const
+{
+    // the columns should keep their sizes, the trend lines should not be reduced
+    if (!m_columnOffset || m_items.count() != m_columnSpan * m_data.rowCount())
+        return 0;
+
+    return -columns * m_columnOffset;
+}
+
+
+void BarChartPlotter::wheelEvent(QWheelEvent *event)
+{
+    if (!m_navigation || !m_model || !m_axisX)
+    {
+        PlotterBase::wheelEvent(event);
+        return;
+    }
+
+    int count = m_model->columnCount();
+
+    int first, span;
+    m_axisX->visibleRange(count, first, span);
+
+    int p_start, p_end;
+    m_axisX->calculatePoints(p_start, p_end);
+
+    if (!span || p_end <= p_start)
+    {
+        PlotterBase::wheelEvent(event);
+        return;
+    }
+
+#if QT_VERSION >= 0x050000
+    int delta = event->angleDelta().y();
+#else
+    int delta = event->delta();
+#endif
+
+    // a wheel step (120) zooms by 25%
+    int newSpan = qRound(span * qPow(1.25, -delta / 120.0));
+    if (newSpan == span)
+        newSpan += (delta > 0) ? -1 : 1;
+
+    newSpan = qBound(1, newSpan, count);
+
+#if QT_VERSION >= 0x050e00
+    double mouseX = event->position().x();
+#else
+    double mouseX = event->pos().x();
+#endif
+
+    // the column under the mouse cursor keeps its place
+    double x = (mouseX - p_start) / (p_end - p_start);
+    int newFirst = qRound(first + x * span - x * newSpan);
+
+    newFirst = qBound(0, newFirst, count - newSpan);
+
+    m_axisX->setViewport(newFirst, (newSpan < count) ? newSpan : 0);
+
+    event->accept();
+}
+
+
+void BarChartPlotter::mousePressEvent(QMouseEvent *event)
+{
+    if (m_navigation && m_model && m_axisX && event->button() == Qt::LeftButton)
+    {
+        int span;
+        m_axisX->visibleRange(m_model->columnCount(), m_dragFirst, span);
+
+        m_dragPos = event->pos();
+    }
+
+    PlotterBase::mousePressEvent(event);
+}
+
+
+void BarChartPlotter::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+        m_dragFirst = -1;
+
+    PlotterBase::mouseReleaseEvent(event);
+}
+
+
+void BarChartPlotter::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_dragFirst >= 0 && m_model && m_axisX && (event->buttons() & Qt::LeftButton))
+    {
+        int count = m_model->columnCount();
+
+        int first, span;
+        m_axisX->visibleRange(count, first, span);
+
+        int p_start, p_end;
+        m_axisX->calculatePoints(p_start, p_end);
+
+        if (span < count && p_end > p_start)
+        {
+            // the columns follow the mouse cursor
+            int dx = event->pos().x() - m_dragPos.x();
+            first = m_dragFirst - qRound(double(dx) * span / (p_end - p_start));
+
+            m_axisX->setViewport(qBound(0, first, count - span), span);
+        }
+    }
+
+    PlotterBase::mouseMoveEvent(event);
+}
+
+
+void BarChartPlotter::updateAutoRange()
+{
+    int last = m_firstColumn + m_columnSpan - 1;
+
+    // reduced from the per-column extremes kept by the snapshot
+    double min, max;
+    bool valid = (m_type == Stacked) ?
+                m_data.stackedRange(m_firstColumn, last, min, max) :
+                m_data.valueRange(m_firstColumn, last, min, max);
+
+    if (!valid)
+        return;
+
+    // the bars start at zero
+    if (m_type == Columns)
+    {
+        min = qMin(min, 0.0);
+        max = qMax(max, 0.0);
+    }
+
+    // empty range could not be mapped
+    if (min == max)
+        max = min + 1;
+
+    // the layout is being calculated for the frame already, but its cached content
+    // of the old scale could not be scrolled
+    if (m_axisY->adjustRanges(min, max))
+        m_repaint = true;
+}
+
+
+PlotterBase* BarChartPlotter::clone() const
+{
+    // the copy of a subclass would not paint as the subclass does
+    if (typeid(*this) != typeid(BarChartPlotter))
+        return 0;
+
+    BarChartPlotter *plotter = new BarChartPlotter();
+
+    plotter->copyState(*this);
+
+    plotter->m_barsize_min = m_barsize_min;
+    plotter->m_barsize_max = m_barsize_max;
+    plotter->m_scale = m_scale;
+    plotter->m_opacity = m_opacity;
+    plotter->m_type = m_type;
+    plotter->m_zeroLinePen = m_zeroLinePen;
+    plotter->m_markerSpacing = m_markerSpacing;
+    plotter->m_autoRange = m_autoRange;
+    plotter->m_customPainting = m_customPainting;
+
+    plotter->m_firstColumn = m_firstColumn;
+    plotter->m_columnSpan = m_columnSpan;
+
+    plotter->m_items = m_items;
+    plotter->m_itemStyles = m_itemStyles;
+    plotter->m_columnLeft = m_columnLeft;
+    plotter->m_columnRight = m_columnRight;
+    plotter->m_columnOffset = m_columnOffset;
+    plotter->m_trendLines = m_trendLines;
+    plotter->m_trendMarkers = m_trendMarkers;
+
+    // the copy is painted by another thread, so the texts are laid out once more
+    plotter->m_valueLabels = m_valueLabels;
+
+    const QFont &font = plotter->valueFont();
+
+    for (int i = 0; i < plotter->m_valueLabels.count(); i++)
+    {
+        QStaticText &text = plotter->m_valueLabels[i].text;
+        text.setText(text.text());
+        text.prepare(QTransform(), font);
+    }
+
+    return plotter;
+}
+
+
+int BarChartPlotter::itemIndex(const QModelIndex &index) const
+{
+    if (!m_model || !index.isValid())
+        return -1;
+
+    int count = m_columnLeft.count();
+    if (!count)
+        return -1;
+
+    int row_count = m_items.count() / count;
+
+    int column = index.column();
+    if (column < m_firstColumn || column >= m_firstColumn + m_columnSpan)
+        return -1;
+
+    // reduced trend: find the item referring the column
+    if (count != m_columnSpan)
+    {
+        int first = 0, last = count - 1;
+        while (first < last)
+        {
+            int middle = (first + last) / 2;
+            if (m_items.at(middle * row_count).column < column)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+
+        column = first;
+    }
+    else
+        column -= m_firstColumn;
+
+    int itemIndex = column * row_count + index.row();
+    if (itemIndex < 0 || itemIndex >= m_items.count())
+        return -1;
+
+    return itemIndex;
+}
+
+
+const PlotterBase::SeriesStyle& BarChartPlotter::itemStyle(const QModelIndex &index) const
+{
+    int itemIndex = this->itemIndex(index);
+    if (itemIndex >= 0)
+    {
+        const BarItem &item = m_items.at(itemIndex);
+
+        if (item.style >= 0 && item.column == index.column())
+            return m_itemStyles.at(item.style);
+    }
+
+    return seriesStyle(index.row());
+}
+
+
+const QFont& BarChartPlotter::valueFont() const
+{
+    // bar values are drawn with the font of the widget
+    return m_type == Trend ? font() : QWidget::font();
+}
+
+
+void BarChartPlotter::drawHighlight(QPainter &p)
+{
+    int itemIndex = this->itemIndex(m_indexUnderMouse);
+    if (itemIndex < 0)
+        return;
+
+    const BarItem &item = m_items.at(itemIndex);
+
+    p.save();
+
+    p.setOpacity(m_opacity);
+
+    if (m_type == Trend)
+    {
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setFont(font());
+    }
+
+    drawSegment(p, item.rect, m_indexUnderMouse, item.value, true);
+    drawValue(p, item.rect, m_indexUnderMouse, item.value, true);
+
+    p.restore();
+}
+
+
+QRect BarChartPlotter::highlightRect(const QModelIndex &index) const
+{
+    int itemIndex = this->itemIndex(index);
+    if (itemIndex < 0)
+        return QRect();
+
+    const BarItem &item = m_items.at(itemIndex);
+
+    // value text and its frame (see drawValue() and drawHighlightedValueFrame())
+    QFontMetrics fm(valueFont());
+    QRect textRect(fm.boundingRect(formattedValue(item.value)));
+
+    QRect frameRect(textRect.adjusted(-3,-3,3,3));
+    QRect textPlace(valueRect(item.rect, textRect, item.value));
+    frameRect.moveCenter(textPlace.center());
+
+    // pen width and antialiasing
+    return (item.rect | item.hitRect | textPlace | frameRect).adjusted(-2, -2, 2, 2);
+}
+
+
+QModelIndex BarChartPlotter::indexAt(const QPoint &pos) const
+{
+    if (!m_model || pos.isNull())
+        return QModelIndex();
+
+    int count = m_columnLeft.count();
+    if (!count)
+        return QModelIndex();
+
+    int row_count = m_items.count() / count;
+
+    // first column which could contain pos
+    const int *right = std::lower_bound(m_columnRight.constBegin(), m_columnRight.constEnd(), pos.x());
+
+    for (int i = right - m_columnRight.constBegin(); i < count; i++)
+    {
+        int left = m_columnLeft.at(i);
+
+        // skip empty columns
+        if (left == INT_MAX)
+            continue;
+
+        // all the next columns are placed to the right of pos
+        if (left > pos.x())
+            break;
+
+        const BarItem *item = m_items.constData() + i * row_count;
+
+        for (int j = 0; j < row_count; j++, item++)
+        {
+            if (item->hitRect.contains(pos))
+                return m_model->index(item->row, item->column);
+        }
+    }
+
+    return QModelIndex();
+}
+
+
+void BarChartPlotter::drawSegment(QPainter &p, QRect rect,
+                                  const QModelIndex &index, double /*value*/,
+                                  bool isHighlighted) const
+{
+    if (isHighlighted)
+    {
+        p.setPen(highlightPen());
+        p.setBrush(highlightBrush());
+    }
+    else
+    {
+        p.setBrush(itemStyle(index).brush);
+        p.setPen(itemPen());
+    }
+
+    countSegments(1);
+
+    if (barType() == Trend)
+    {
+        p.drawEllipse(rect.topLeft(), 3, 3);
+        return;
+    }
+
+    p.drawRect(rect);
+}
+
+
+void BarChartPlotter::drawValue(QPainter &p, QRect rect,
+                                  const QModelIndex &index, double value,
+                                  bool isHighlighted) const
+{
+    int flags = Qt::AlignCenter;
+
+    QString &text = textBuffer();
+    formatValue(value, text);
+
+    QRect textRect(p.fontMetrics().boundingRect(text));
+
+/*    switch (barType())
+    {
+        case Columns:
+            if (value < 0)
+            {
+                flags = Qt::AlignHCenter | Qt::AlignTop;
+                rect.setTop(rect.bottom() + 4);
+                rect.setHeight(textRect.height());
+            }
+            else
+            {
+                flags = Qt::AlignHCenter | Qt::AlignBottom;
+                rect.setTop(rect.top() - textRect.height() - 4);
+                rect.setHeight(textRect.height());
+            }
+
+            if (rect.width() < textRect.width() + 4)
+                rect.setWidth(textRect.width() + 4);
+
+            if (isHighlighted)
+            {
+                flags = Qt::AlignCenter;
+                QRect frameRect = drawHighlightedValueFrame(p, rect, textRect);
+                drawValueText(p, frameRect, flags, true, index, text);
+            }
+            else
+                drawValueText(p, rect, flags, isHighlighted, index, text);
+
+            break;
+
+        case Stacked:
+            if (textRect.height() > rect.height() || textRect.width() > rect.width())
+            {
+                if (isHighlighted)
+                {
+                    QRect frameRect = drawHighlightedValueFrame(p, rect, textRect);
+                    drawValueText(p, frameRect, flags, true, index, text);
+                }
+            }
+            else
+            {
+                drawValueText(p, rect, flags, isHighlighted, index, text);
+            }
+
+            break;
+
+        case Trend:*/
+            rect = valueRect(rect, textRect, value);
+
+            if (isHighlighted)
+            {
+                drawHighlightedValueFrame(p, rect, textRect);
+            }
+
+            drawValueText(p, rect, flags, isHighlighted, index, text);
+
+/*            break;
+    }*/
+
+}
+
+
+QRect BarChartPlotter::valueRect(QRect rect, const QRect &textRect, double value) const
+{
+    int rectWidth = rect.width();
+    rect.setSize(textRect.size());
+    rect.moveLeft(rect.left() + (rectWidth - textRect.width()) /2);
+
+    rect.moveTop(rect.top() - rect.height()/2);
+    if (value < 0)
+        rect.moveTop(rect.top() + rect.height());
+    else
+        rect.moveTop(rect.top() - rect.height());
+
+    if (rect.width() < textRect.width() + 4)
+    {
+        rect.setWidth(textRect.width() + 4);
+        rect.moveLeft(rect.left() - 2);
+    }
+
+    return rect;
+}
+
+
+void BarChartPlotter::drawValueText(QPainter &p, const QRect &rect, int flags, bool isHighlighted, const QModelIndex &index, const QString &text) const
+{
+
+    if (isHighlighted)
+    {
+        p.setPen(QPen(highlightTextColor()));
+    }
+    else
+    {
+        p.setPen(itemStyle(index).textPen);
+    }
+
+    countLabels(1);
+
+    p.drawText(rect, flags, text);
+}
+
+
+QRect BarChartPlotter::drawHighlightedValueFrame(QPainter &p, const QRect &rect, const QRect &textRect) const
+{    
+    QRect backRect(textRect.adjusted(-3,-3,3,3));
+    backRect.moveLeft(rect.center().x() - backRect.width()/2);
+    backRect.moveTop(rect.center().y() - backRect.height()/2);
+
+    p.setPen(highlightPen());
+    p.setBrush(highlightBrush());
+    p.drawRect(backRect);
+
+    return backRect;
+}
+
+
+void BarChartPlotter::BarPainter::drawBarItem(QPainter &p, QRect rect,
+                                              const QPen &pen, const QBrush &brush,
+                                              const QModelIndex &/*index*/, double /*value*/)
+{
+    p.setPen(pen);
+    p.setBrush(brush);
+    p.drawRect(rect);
+}
+
+
+void BarChartPlotter::BarPainter::drawValueText(QPainter &p, QRect rect, int flags,
+                                                const QPen &pen, const QBrush &brush,
+                                                const QModelIndex &index, double /*value*/)
+{
+    p.setPen(pen);
+    p.setBrush(brush);
+    //p.drawText(rect, flags, QString::number(value));
+    p.drawText(rect, flags, index.data(Qt::DisplayRole).toString());
+}
+
+
+void BarChartPlotter::BarPainter::drawBars(BarChartPlotter *plotter, QPainter &p,
+                                          int first, int last, int row_count)
+{
+    const BarItem *items = plotter->m_items.constData();
+
+    int begin = first * row_count;
+    int end = (last + 1) * row_count;
+
+    p.setOpacity(plotter->barOpacity());
+
+    // segments sorted by their style: a single batch per row;
+    // the ones having own style in the model are drawn one by one
+    QVector<QRect> rects(last - first + 1);
+
+    for (int j = 0; j < row_count; j++)
+    {
+        QRect *rect = rects.data();
+
+        for (int i = begin + j; i < end; i += row_count)
+        {
+            const BarItem &item = items[i];
+
+            if (item.style >= 0 || plotter->m_customPainting)
+                plotter->drawSegment(p, item.rect, item.index, item.value, false);
+            else
+                *rect++ = item.rect;
+        }
+
+        p.setPen(plotter->itemPen());
+        p.setBrush(plotter->seriesStyle(j).brush);
+        p.drawRects(rects.constData(), rect - rects.constData());
+
+        plotter->countSegments(rect - rects.constData());
+    }
+
+    // values are drawn over all the segments
+    plotter->drawValueLabels(p, begin, end);
+}
+
+
+void BarChartPlotter::StackedBarPainter::layout(
+    BarChartPlotter *plotter,
+    int count,
+    int row_count,
+    int p_start,
+    int p_offs,
+    int bar_size)
+{
+    BarItem *item = plotter->m_items.data();
+
+    int p_zero = plotter->axisY()->toView(0);
+
+    QVector<int> p_stacked(row_count);
+
+    for (int i = 0; i < count; i++)
+    {
+        int p_d = p_start + p_offs*i + (p_offs-bar_size)/2;
+
+        int p_y = p_zero;
+        int p_ny = p_y;
+
+        int c = plotter->m_firstColumn + i;
+
+        const double *values = plotter->m_data.column(c);
+
+        plotter->axisY()->mapToView(plotter->m_data.stackedColumn(c), p_stacked.data(), row_count);
+
+        for (int j = 0; j < row_count; j++, item++)
+        {
+            QRect itemRect;
+
+            double value = values[j];
+            int p_h = p_stacked[j];
+
+            if (value < 0)
+            {
+                itemRect = QRect(p_d, p_ny, bar_size, p_h-p_ny);
+
+                p_ny = p_h;
+            }
+            else
+            {
+                itemRect = QRect(p_d, p_h, bar_size, p_y-p_h);
+
+                p_y = p_h;
+            }
+
+            BarItem barItem = { j, c, value, itemRect, itemRect };
+            *item = barItem;
+        }
+    }
+}
+
+
+void BarChartPlotter::StackedBarPainter::draw(
+    BarChartPlotter *plotter,
+    QPainter &p,
+    int first,
+    int last,
+    int row_count)
+{
+    drawBars(plotter, p, first, last, row_count);
+}
+
+
+void BarChartPlotter::ColumnBarPainter::layout(
+    BarChartPlotter *plotter,
+    int count,
+    int row_count,
+    int p_start,
+    int p_offs,
+    int bar_size)
+{
+    int single_bar_size = bar_size/row_count;
+    if (!single_bar_size)
+    {
+        // bars are too narrow to be shown
+        plotter->m_items.clear();
+        return;
+    }
+
+    BarItem *item = plotter->m_items.data();
+
+    int p_y = plotter->axisY()->toView(0);
+
+    QVector<int> p_values(row_count);
+
+    for (int i = 0; i < count; i++)
+    {
+        int p_d = p_start + p_offs*i + (p_offs-bar_size)/2;
+
+        int c = plotter->m_firstColumn + i;
+
+        const double *values = plotter->m_data.column(c);
+
+        plotter->axisY()->mapToView(values, p_values.data(), row_count);
+
+        for (int j = 0; j < row_count; j++, item++)
+        {
+            double value = values[j];
+
+            int p_h = p_values[j];
+
+            QRect itemRect;
+
+            if (value < 0)
+            {
+                itemRect = QRect(p_d, p_y, single_bar_size, p_h-p_y);
+            }
+            else
+            {
+                itemRect = QRect(p_d, p_h, single_bar_size, p_y-p_h);
+            }
+
+            BarItem barItem = { j, c, value, itemRect, itemRect };
+            *item = barItem;
+
+            p_d += single_bar_size;
+        }
+    }
+}
+
+
+void BarChartPlotter::ColumnBarPainter::draw(
+    BarChartPlotter *plotter,
+    QPainter &p,
+    int first,
+    int last,
+    int row_count)
+{
+    drawBars(plotter, p, first, last, row_count);
+}
+
+
+static inline void appendTrendPoint(QPolygon &line, const QPoint &pt)
+{
+    if (line.isEmpty() || line.last() != pt)
+        line.append(pt);
+}
+
+
+void BarChartPlotter::TrendPainter::layout(
+    BarChartPlotter *plotter,
+    int count,
+    int row_count,
+    int p_start,
+    int p_offs,
+    int /*bar_size*/)
+{
+    plotter->m_trendMarkers = (p_offs >= plotter->m_markerSpacing);
+
+    // more columns than pixels
+    if (!p_offs)
+    {
+        layoutReduced(plotter, count, row_count, p_start);
+        return;
+    }
+
+    BarItem *item = plotter->m_items.data();
+
+    QVector<int> p_values(row_count);
+
+    for (int i = 0; i < count; i++)
+    {
+        int x = p_start + p_offs*i + p_offs/2;
+
+        int c = plotter->m_firstColumn + i;
+
+        const double *values = plotter->m_data.column(c);
+
+        plotter->axisY()->mapToView(values, p_values.data(), row_count);
+
+        for (int j = 0; j < row_count; j++, item++)
+        {
+            double value = values[j];
+
+            int y = p_values[j];
+            QRect itemRect(x,y,1,1);
+
+            BarItem barItem = { j, c, value, itemRect, QRect(x-3, y-3, 7, 7) };
+            *item = barItem;
+        }
+    }
+
+    plotter->m_trendLines.resize(row_count);
+
+    const BarItem *items = plotter->m_items.constData();
+
+    for (int j = 0; j < row_count; j++)
+    {
+        QPolygon &line = plotter->m_trendLines[j];
+        line.reserve(count);
+
+        for (int i = 0; i < count; i++)
+            appendTrendPoint(line, items[i*row_count + j].rect.topLeft());
+    }
+}
+
+
+void BarChartPlotter::TrendPainter::layoutReduced(
+    BarChartPlotter *plotter,
+    int count,
+    int row_count,
+    int p_start)
+{
+    int p_axis_start, p_end;
+    plotter->axisX()->calculatePoints(p_axis_start, p_end);
+
+    int width = p_end - p_start;
+    if (width <= 0)
+    {
+        plotter->m_items.clear();
+        return;
+    }
+
+    const ChartData &data = plotter->m_data;
+    AxisBase *axisY = plotter->axisY();
+
+    // a single item per pixel column, it refers the first model column placed there
+    plotter->m_items.resize(width * row_count);
+    plotter->m_trendLines.resize(row_count);
+
+    BarItem *item = plotter->m_items.data();
+
+    for (int x = 0; x < width; x++)
+    {
+        // columns i having i * width / count == x
+        int first = (qint64(x) * count + width - 1) / width + plotter->m_firstColumn;
+        int last = (qint64(x + 1) * count + width - 1) / width - 1 + plotter->m_firstColumn;
+
+        int p_x = p_start + x;
+
+        for (int j = 0; j < row_count; j++, item++)
+        {
+            double v_first = data.value(j, first);
+            double v_last = data.value(j, last);
+
+            double v_min, v_max, v_sum;
+            data.summary(j, first, last, v_min, v_max, v_sum);
+
+            int y = axisY->toView(v_first);
+
+            BarItem barItem = { j, first, v_first, QRect(p_x, y, 1, 1), QRect(p_x-3, y-3, 7, 7) };
+            *item = barItem;
+
+            // reduce the line to the first, minimal, maximal and last point of the pixel column (M4);
+            // order of the extremes is not known, so the one nearest to the first point goes first
+            QPolygon &line = plotter->m_trendLines[j];
+
+            QPoint minPoint(p_x, axisY->toView(v_min));
+            QPoint maxPoint(p_x, axisY->toView(v_max));
+
+            appendTrendPoint(line, QPoint(p_x, y));
+
+            if (v_first - v_min < v_max - v_first)
+            {
+                appendTrendPoint(line, minPoint);
+                appendTrendPoint(line, maxPoint);
+            }
+            else
+            {
+                appendTrendPoint(line, maxPoint);
+                appendTrendPoint(line, minPoint);
+            }
+
+            appendTrendPoint(line, QPoint(p_x, axisY->toView(v_last)));
+        }
+    }
+}
+
+
+// index of the first point of the line placed at or after x
+static int trendPointAt(const QPolygon &line, int x)
+{
+    int first = 0, last = line.count();
+    while (first < last)
+    {
+        int middle = (first + last) / 2;
+        if (line.at(middle).x() < x)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    return first;
+}
+
+
+void BarChartPlotter::TrendPainter::draw(
+    BarChartPlotter *plotter,
+    QPainter &p,
+    int first,
+    int last,
+    int row_count)
+{
+    p.save();
+    p.setRenderHint(QPainter::Antialiasing);
+
+    p.setOpacity(plotter->barOpacity());
+
+    p.setFont(plotter->font());
+
+    // x ranges of the lines to draw
+    int x_first = plotter->m_items.at(first * row_count).rect.x();
+    int x_last = plotter->m_items.at(last * row_count).rect.x();
+
+    for (int j = 0; j < row_count; j++)
+    {
+        const QBrush &brush = plotter->seriesStyle(j).brush;
+
+        const QPolygon &line = plotter->m_trendLines.at(j);
+        int p_first = trendPointAt(line, x_first);
+        int p_count = trendPointAt(line, x_last + 1) - p_first;
+
+        // points are too dense to show their markers and values
+        if (!plotter->m_trendMarkers)
+        {
+            p.setPen(QPen(brush, 2));
+            p.drawPolyline(line.constData() + p_first, p_count);
+
+            plotter->countSegments(qMax(0, p_count - 1));
+            plotter->countLabels(0, last - first + 1);
+            continue;
+        }
+
+        p.setPen(QPen(brush, 2));
+        p.drawPolyline(line.constData() + p_first, p_count);
+
+        plotter->countSegments(qMax(0, p_count - 1));
+
+        //p.setPen(pen);
+        //p.setBrush(brush);
+        for (int i = first; i <= last; i++)
+        {
+            const BarItem &item = plotter->m_items.at(i*row_count + j);
+
+            plotter->drawSegment(p, item.rect, item.index, item.value, false);
+
+            //p.drawEllipse(points.at(i), 3, 3);
+        }
+    }
+
+    // values are drawn over all the lines
+    if (plotter->m_trendMarkers)
+        plotter->drawValueLabels(p, first * row_count, (last + 1) * row_count);
+
+    p.restore();
+}
+
+
+} // namespace
@@ -1,160 +1,319 @@
-#ifndef BARCHARTPLOTTER_H
-#define BARCHARTPLOTTER_H
-
-
-#include "plotterbase.h"
-
-
-namespace QSint
-{
-
-
-/**
-    \brief Class representing a barchart plotting widget.
-    \since 0.2.1
-
-    \image html StackedChart.png An example of BarChartPlotter with \a Stacked type
-    \image html ColumnChart.png An example of BarChartPlotter with \a Columns type
-    \image html TrendChart.png An example of BarChartPlotter with \a Trend type
-
-    BarChartPlotter provides following types of the charts (see \a BarChartType enum):
-    - Stacked bars
-    - Column-based bars
-    - Trends
-*/
-class BarChartPlotter : public PlotterBase
-{
-    Q_OBJECT
-public:
-    explicit BarChartPlotter(QWidget *parent = 0);
-
-
-    /// \brief Defines type of the chart.
-    enum BarChartType
-    {
-        /// bar represents single model column
-        Stacked,
-        /// bar represents single model value
-        Columns,
-        /// trend-like plot
-        Trend
-    };
-
-    /// Sets the plotter type to \a type.
-    void setBarType(BarChartType type);
-    /// Retrieves type of the plotter.
-    inline BarChartType barType() const { return m_type; }
-
-    /// Sets minimum and maximum sizes of a single bar.
-    /// Valid for \b Stacked and \b Columns plotter types.
-    void setBarSize(int min, int max = INT_MAX);
-    /// Retrieves minimum bar size. \sa setBarSize()
-    inline int barSizeMin() const { return m_barsize_min; }
-    /// Retrieves maximum bar size. \sa setBarSize()
-    inline int barSizeMax() const { return m_barsize_max; }
-
-    /** Sets scale coefficient to \a scale.
-        This value defines how many space a single model column representation could get.
-        It should be in ranges between 0.1 and 1.0, 0.5 is the default.
-        Valid for \b Stacked and \b Columns plotter types.
-     */
-    void setBarScale(double scale);
-    /// Retrieves bar scale coefficient. \sa setBarScale()
-    inline double barScale() const { return m_scale; }
-
-    /// Sets opacity of a single bar to \a value (should be in ranges between 0.1 and 1.0, 1.0 is the default).
-    void setBarOpacity(double value);
-    /// Retrieves bar opacity. \sa setBarOpacity()
-    inline double barOpacity() const { return m_opacity; }
-
-
-    /// Sets pen of zero line of the plotter to \a pen.
-    void setZeroLinePen(const QPen &pen);
-    /// Retrieves zero line pen. \sa setZeroLinePen()
-    inline const QPen& zeroLinePen() const { return m_zeroLinePen; }
-
-protected:
-    virtual void drawContent(QPainter &p);
-
-    virtual void drawSegment(QPainter &p, QRect rect,
-                              const QModelIndex &index, double value,
-                              bool isHighlighted) const;
-
-    virtual void drawValue(QPainter &p, QRect rect,
-                              const QModelIndex &index, double value,
-                              bool isHighlighted) const;
-
-    virtual void drawValueText(QPainter &p,
-                               const QRect &rect,
-                               int flags,
-                               bool isHighlighted,
-                               const QModelIndex &index,
-                               const QString &text) const;
-
-    virtual QRect drawHighlightedValueFrame(QPainter &p,
-                                           const QRect &rect,
-                                           const QRect &textRect) const;
-
-    int m_barsize_min, m_barsize_max;
-    double m_scale;
-    double m_opacity;
-    BarChartType m_type;
-
-    QPen m_zeroLinePen;
-
-protected:
-    class BarPainter
-    {
-    protected:
-        static void drawBarItem(QPainter &p, QRect rect,
-                                 const QPen &pen, const QBrush &brush,
-                                 const QModelIndex &index,
-                                 double value);
-
-        static void drawValueText(QPainter &p, QRect rect, int flags,
-                                 const QPen &pen, const QBrush &brush,
-                                 const QModelIndex &index,
-                                 double value);
-    };
-
-    class StackedBarPainter: public BarPainter
-    {
-    public:
-        static void draw(BarChartPlotter *plotter,
-                         QPainter &p,
-                         int count,
-                         int row_count,
-                         int p_start,
-                         int p_offs,
-                         int bar_size);
-    };
-
-    class ColumnBarPainter: public BarPainter
-    {
-    public:
-        static void draw(BarChartPlotter *plotter,
-                         QPainter &p,
-                         int count,
-                         int row_count,
-                         int p_start,
-                         int p_offs,
-                         int bar_size);
-    };
-
-    class TrendPainter: public BarPainter
-    {
-    public:
-        static void draw(BarChartPlotter *plotter,
-                         QPainter &p,
-                         int count,
-                         int row_count,
-                         int p_start,
-                         int p_offs,
-                         int bar_size);
-    };
-};
-
-
-} // namespace
-
-#endif // BARCHARTPLOTTER_H
+#ifndef BARCHARTPLOTTER_H
+#define BARCHARTPLOTTER_H
+
+
+#include <QStaticText>
+
+#include "plotterbase.h"
+
+
+namespace QSint
+{
+
+
+/**
+    \brief Class representing a barchart plotting widget.
+    \since 0.2.1
+
+    \image html StackedChart.png An example of BarChartPlotter with \a Stacked type
+    \image html ColumnChart.png An example of BarChartPlotter with \a Columns type
+    \image html TrendChart.png An example of BarChartPlotter with \a Trend type
+
+    BarChartPlotter provides following types of the charts (see \a BarChartType enum):
+    - Stacked bars
+    - Column-based bars
+    - Trends
+*/
+class BarChartPlotter : public PlotterBase
+{
+    Q_OBJECT
+public:
+    explicit BarChartPlotter(QWidget *parent = 0);
+
+
+    /// \brief Defines type of the chart.
+    enum BarChartType
+    {
+        /// bar represents single model column
+        Stacked,
+        /// bar represents single model value
+        Columns,
+        /// trend-like plot
+        Trend
+    };
+
+    /// Sets the plotter type to \a type.
+    void setBarType(BarChartType type);
+    /// Retrieves type of the plotter.
+    inline BarChartType barType() const { return m_type; }
+
+    /// Sets minimum and maximum sizes of a single bar.
+    /// Valid for \b Stacked and \b Columns plotter types.
+    void setBarSize(int min, int max = INT_MAX);
+    /// Retrieves minimum bar size. \sa setBarSize()
+    inline int barSizeMin() const { return m_barsize_min; }
+    /// Retrieves maximum bar size. \sa setBarSize()
+    inline int barSizeMax() const { return m_barsize_max; }
+
+    /** Sets scale coefficient to \a scale.
+        This value defines how many space a single model column representation could get.
+        It should be in ranges between 0.1 and 1.0, 0.5 is the default.
+        Valid for \b Stacked and \b Columns plotter types.
+     */
+    void setBarScale(double scale);
+    /// Retrieves bar scale coefficient. \sa setBarScale()
+    inline double barScale() const { return m_scale; }
+
+    /// Sets opacity of a single bar to \a value (should be in ranges between 0.1 and 1.0, 1.0 is the default).
+    void setBarOpacity(double value);
+    /// Retrieves bar opacity. \sa setBarOpacity()
+    inline double barOpacity() const { return m_opacity; }
+
+
+    /// Sets pen of zero line of the plotter to \a pen.
+    void setZeroLinePen(const QPen &pen);
+    /// Retrieves zero line pen. \sa setZeroLinePen()
+    inline const QPen& zeroLinePen() const { return m_zeroLinePen; }
+
+    /** Sets minimal horizontal distance (in pixels) between two neighbour points of a trend
+        to \a pixels. If the points are placed denser, their markers and values are not drawn
+        (only the trend lines are shown). 4 is the default, 0 means to always draw them.
+        Valid for \b Trend plotter type.
+        \since 0.2.3
+     */
+    void setTrendMarkerSpacing(int pixels);
+    /// Retrieves minimal distance between the trend markers. \sa setTrendMarkerSpacing()
+    inline int trendMarkerSpacing() const { return m_markerSpacing; }
+
+    /** Enables (\a on=true) or disables (\a on=false, the default) automatic ranges of Y axis.
+        The ranges are taken from the data snapshot of the visible columns: minimum and maximum
+        of the values (including 0 for \b Columns type), or the extreme negative and positive
+        sums of a column for \b Stacked type. They follow the data changes without reading the model.
+        \since 0.2.3
+     */
+    void setAutoRange(bool on);
+    /// Returns true if the ranges of Y axis are set automatically. \sa setAutoRange()
+    inline bool autoRange() const { return m_autoRange; }
+
+    /** Enables zooming of the model columns by the mouse wheel and panning them by dragging
+        with the left mouse button if \a on is true (disabled by default).
+        Visible columns are defined by the viewport of X axis (see AxisBase::setViewport()).
+        \since 0.2.3
+     */
+    void setMouseNavigation(bool on);
+    /// Returns true if the mouse zooming and panning are enabled. \sa setMouseNavigation()
+    inline bool mouseNavigation() const { return m_navigation; }
+
+    /** Enables (\a on=true) or disables (\a on=false, the default) painting of every data item
+        and its value text by drawSegment() and drawValue(), so their reimplementations are used
+        for all the items. By default, the items are drawn in a batch per series and the value
+        texts are laid out in advance; only the items having own style in the model (and the trend
+        markers) are passed to drawSegment(), and only the highlighted item to drawValue().
+        \since 0.2.3
+     */
+    void setCustomItemPainting(bool on);
+    /// Returns true if every item is painted by drawSegment() and drawValue(). \sa setCustomItemPainting()
+    inline bool customItemPainting() const { return m_customPainting; }
+
+    virtual QModelIndex indexAt(const QPoint &pos) const;
+
+protected:
+    virtual void drawContent(QPainter &p);
+    virtual void drawHighlight(QPainter &p);
+    virtual QRect highlightRect(const QModelIndex &index) const;
+    virtual void calculateLayout();
+    virtual int scrollDistance(int columns) const;
+    virtual PlotterBase* clone() const;
+
+    virtual void wheelEvent(QWheelEvent *event);
+    virtual void mousePressEvent(QMouseEvent *event);
+    virtual void mouseReleaseEvent(QMouseEvent *event);
+    virtual void mouseMoveEvent(QMouseEvent *event);
+
+    virtual void drawSegment(QPainter &p, QRect rect,
+                              const QModelIndex &index, double value,
+                              bool isHighlighted) const;
+
+    virtual void drawValue(QPainter &p, QRect rect,
+                              const QModelIndex &index, double value,
+                              bool isHighlighted) const;
+
+    virtual void drawValueText(QPainter &p,
+                               const QRect &rect,
+                               int flags,
+                               bool isHighlighted,
+                               const QModelIndex &index,
+                               const QString &text) const;
+
+    virtual QRect drawHighlightedValueFrame(QPainter &p,
+                                           const QRect &rect,
+                                           const QRect &textRect) const;
+
+    /// Retrieves rectangle of the value text of size \a textRect for the item at \a rect.
+    QRect valueRect(QRect rect, const QRect &textRect, double value) const;
+    /// Retrieves index of the item representing \a index in m_items, or -1 if there is no such item.
+    int itemIndex(const QModelIndex &index) const;
+    /// Retrieves style of the item at \a index: its own one if set in the model, or the style of its series.
+    const SeriesStyle& itemStyle(const QModelIndex &index) const;
+    /// Retrieves font of the value texts.
+    const QFont& valueFont() const;
+    /// Sets ranges of Y axis to the ones of the visible columns (see setAutoRange()).
+    void updateAutoRange();
+
+    /** Lays out the value texts of the items, skipping the ones which would overlap
+        the previous texts or would not fit into the plotter. Called by calculateLayout().
+        \since 0.2.3
+    */
+    void calculateValueLabels();
+    /// Draws the value texts of the items from \a begin to \a end (excluding) in m_items.
+    void drawValueLabels(QPainter &p, int begin, int end) const;
+
+    int m_barsize_min, m_barsize_max;
+    double m_scale;
+    double m_opacity;
+    BarChartType m_type;
+
+    QPen m_zeroLinePen;
+
+    int m_markerSpacing;
+
+    bool m_autoRange;
+
+    bool m_customPainting;
+
+    bool m_navigation;
+    /// Mouse position and first visible column when dragging has been started (-1 if not dragging).
+    QPoint m_dragPos;
+    int m_dragFirst;
+
+    /// Visible model columns (see AxisBase::visibleRange()).
+    int m_firstColumn, m_columnSpan;
+
+    /// Geometry of a single data item.
+    struct BarItem
+    {
+        int row, column;
+        double value;
+        /// rectangle passed to drawSegment() and drawValue()
+        QRect rect;
+        /// area which reacts on the mouse
+        QRect hitRect;
+        /// model index of the item, taken only for the items drawn by drawSegment() while painting
+        /// (having own style, trend markers, or all of them, see setCustomItemPainting()); invalid for the others
+        QModelIndex index;
+        /// own style of the item in m_itemStyles, or -1 if it is drawn with the style of its series
+        int style;
+    };
+
+    /// Data items stored column by column (see calculateLayout()).
+    QVector<BarItem> m_items;
+    /// Styles of the items having their own brush or text color in the model.
+    QVector<SeriesStyle> m_itemStyles;
+    /// Horizontal extents of the item hit areas, per column (non-decreasing).
+    QVector<int> m_columnLeft, m_columnRight;
+    /// Distance between the columns, or 0 if they are not placed uniformly by whole pixels.
+    int m_columnOffset;
+
+    /// Value text of a data item laid out by calculateValueLabels().
+    struct ValueLabel
+    {
+        /// index of the item in m_items
+        int item;
+        /// position of the text
+        QPointF pos;
+        QStaticText text;
+    };
+
+    /// Value texts to be drawn, sorted by their items.
+    QVector<ValueLabel> m_valueLabels;
+
+    /// Trend lines (one per row) reduced to at most 4 points per pixel column (Trend only).
+    QVector<QPolygon> m_trendLines;
+    /// If markers and values of the trend points should be drawn (Trend only).
+    bool m_trendMarkers;
+
+protected:
+    class BarPainter
+    {
+    protected:
+        static void drawBarItem(QPainter &p, QRect rect,
+                                 const QPen &pen, const QBrush &brush,
+                                 const QModelIndex &index,
+                                 double value);
+
+        static void drawValueText(QPainter &p, QRect rect, int flags,
+                                 const QPen &pen, const QBrush &brush,
+                                 const QModelIndex &index,
+                                 double value);
+
+        /// Draws the bar items of columns from \a first to \a last:
+        /// the segments in a batch per row, then the cached value texts.
+        static void drawBars(BarChartPlotter *plotter,
+                             QPainter &p,
+                             int first,
+                             int last,
+                             int row_count);
+    };
+
+    class StackedBarPainter: public BarPainter
+    {
+    public:
+        static void layout(BarChartPlotter *plotter,
+                           int count,
+                           int row_count,
+                           int p_start,
+                           int p_offs,
+                           int bar_size);
+
+        static void draw(BarChartPlotter *plotter,
+                         QPainter &p,
+                         int first,
+                         int last,
+                         int row_count);
+    };
+
+    class ColumnBarPainter: public BarPainter
+    {
+    public:
+        static void layout(BarChartPlotter *plotter,
+                           int count,
+                           int row_count,
+                           int p_start,
+                           int p_offs,
+                           int bar_size);
+
+        static void draw(BarChartPlotter *plotter,
+                         QPainter &p,
+                         int first,
+                         int last,
+                         int row_count);
+    };
+
+    class TrendPainter: public BarPainter
+    {
+    public:
+        static void layout(BarChartPlotter *plotter,
+                           int count,
+                           int row_count,
+                           int p_start,
+                           int p_offs,
+                           int bar_size);
+
+        static void draw(BarChartPlotter *plotter,
+                         QPainter &p,
+                         int first,
+                         int last,
+                         int row_count);
+
+    protected:
+        static void layoutReduced(BarChartPlotter *plotter,
+                                  int count,
+                                  int row_count,
+                                  int p_start);
+    };
+};
+
+
+} // namespace
+
+#endif // BARCHARTPLOTTER_H
@@ -0,0 +1,537 @@
+#include "chartdata.h"
+#include "chartsimd_p.h"
+
+#include <string.h>
+
+
+namespace QSint
+{
+
+
+ChartData::ChartData() :
+    m_rows(0),
+    m_columns(0),
+    m_capacity(0),
+    m_first(0),
+    m_cellStylesEnabled(false),
+    m_pyramid(false)
+{
+}
+
+
+void ChartData::read(const QAbstractItemModel *model)
+{
+    if (!model)
+    {
+        clear();
+        return;
+    }
+
+    m_rows = model->rowCount();
+    m_columns = model->columnCount();
+    m_capacity = m_columns;
+    m_first = 0;
+
+    m_values.resize(m_rows * m_columns);
+    m_stacked.resize(m_rows * m_columns);
+    m_positive.resize(m_columns);
+    m_negative.resize(m_columns);
+    m_minimum.resize(m_columns);
+    m_maximum.resize(m_columns);
+
+    m_cellStyles.clear();
+    if (m_cellStylesEnabled)
+        m_cellStyles.resize(m_columns);
+
+    for (int c = 0; c < m_columns; c++)
+    {
+        readColumn(model, c, 0, m_rows - 1);
+    }
+
+    m_levels.clear();
+    updatePyramid(0, m_capacity - 1);
+}
+
+
+void ChartData::update(const QAbstractItemModel *model, int top, int left, int bottom, int right)
+{
+    if (!model)
+        return;
+
+    top = qMax(top, 0);
+    left = qMax(left, 0);
+    bottom = qMin(bottom, m_rows - 1);
+    right = qMin(right, m_columns - 1);
+
+    if (top > bottom || left > right)
+        return;
+
+    for (int c = left; c <= right; c++)
+    {
+        readColumn(model, c, top, bottom);
+    }
+
+    int first = slot(left), last = slot(right);
+    if (first <= last)
+    {
+        updatePyramid(first, last);
+    }
+    else
+    {
+        updatePyramid(first, m_capacity - 1);
+        updatePyramid(0, last);
+    }
+}
+
+
+void ChartData::scroll(const QAbstractItemModel *model, int removed, int added)
+{
+    if (!model)
+    {
+        clear();
+        return;
+    }
+
+    if (removed >= m_columns || model->rowCount() != m_rows)
+    {
+        read(model);
+        return;
+    }
+
+    // removing of the first columns just moves the ring start
+    if (removed > 0)
+    {
+        m_first = slot(removed);
+        m_columns -= removed;
+    }
+
+    if (added <= 0)
+        return;
+
+    reserve(m_columns + added);
+
+    int first = model->columnCount() - added;
+
+    for (int c = 0; c < added; c++)
+    {
+        int column = m_columns++;
+
+        // the slot could keep styles of a removed column
+        if (m_cellStylesEnabled)
+            m_cellStyles[slot(column)].clear();
+
+        for (int r = 0; r < m_rows; r++)
+        {
+            readValue(model, model->index(r, first + c), slot(column));
+        }
+
+        updateColumn(slot(column));
+        updatePyramid(slot(column), slot(column));
+    }
+}
+
+
+void ChartData::clear()
+{
+    m_rows = m_columns = 0;
+    m_capacity = m_first = 0;
+
+    m_values.clear();
+    m_stacked.clear();
+    m_positive.clear();
+    m_negative.clear();
+    m_minimum.clear();
+    m_maximum.clear();
+    m_cellStyles.clear();
+    m_levels.clear();
+}
+
+
+void ChartData::setCellStylesEnabled(bool on)
+{
+    m_cellStylesEnabled = on;
+
+    // the styles are read with the values
+    m_cellStyles.clear();
+    if (on)
+        m_cellStyles.resize(m_capacity);
+}
+
+
+const ChartData::CellStyle* ChartData::cellStyle(int row, int column) const
+{
+    if (!m_cellStylesEnabled)
+        return NULL;
+
+    const QVector<CellStyle> &styles = m_cellStyles.at(slot(column));
+
+    for (int i = 0; i < styles.count(); i++)
+    {
+        if (styles.at(i).row == row)
+            return &styles.at(i);
+    }
+
+    return NULL;
+}
+
+
+void ChartData::setPyramidEnabled(bool on)
+{
+    if (m_pyramid == on)
+        return;
+
+    m_pyramid = on;
+
+    m_levels.clear();
+    updatePyramid(0, m_capacity - 1);
+}
+
+
+void ChartData::summary(int row, int firstColumn, int lastColumn,
+                        double &min, double &max, double &sum) const
+{
+    min = max = value(row, firstColumn);
+    sum = 0;
+
+    int first = slot(firstColumn), last = slot(lastColumn);
+    if (first <= last)
+    {
+        summarySlots(row, first, last, min, max, sum);
+    }
+    else
+    {
+        summarySlots(row, first, m_capacity - 1, min, max, sum);
+        summarySlots(row, 0, last, min, max, sum);
+    }
+}
+
+
+bool ChartData::valueRange(int firstColumn, int lastColumn, double &min, double &max) const
+{
+    return columnsRange(m_minimum, m_maximum, firstColumn, lastColumn, min, max);
+}
+
+
+bool ChartData::stackedRange(int firstColumn, int lastColumn, double &min, double &max) const
+{
+    return columnsRange(m_negative, m_positive, firstColumn, lastColumn, min, max);
+}
+
+
+/// Updates \a min by \a count values of \a mins and \a max by the ones of \a maxs.
+static void reduceRange(const double *mins, const double *maxs, int count, double &min, double &max)
+{
+    int i = 0;
+
+#if defined(QSINT_CHARTS_AVX)
+    if (count >= 4)
+    {
+        __m256d v_min = _mm256_loadu_pd(mins);
+        __m256d v_max = _mm256_loadu_pd(maxs);
+
+        for (i = 4; i + 4 <= count; i += 4)
+        {
+            v_min = _mm256_min_pd(v_min, _mm256_loadu_pd(mins + i));
+            v_max = _mm256_max_pd(v_max, _mm256_loadu_pd(maxs + i));
+        }
+
+        double lanes[4];
+
+        _mm256_storeu_pd(lanes, v_min);
+        min = qMin(min, qMin(qMin(lanes[0], lanes[1]), qMin(lanes[2], lanes[3])));
+
+        _mm256_storeu_pd(lanes, v_max);
+        max = qMax(max, qMax(qMax(lanes[0], lanes[1]), qMax(lanes[2], lanes[3])));
+    }
+#elif defined(QSINT_CHARTS_SSE2)
+    if (count >= 2)
+    {
+        __m128d v_min = _mm_loadu_pd(mins);
+        __m128d v_max = _mm_loadu_pd(maxs);
+
+        for (i = 2; i + 2 <= count; i += 2)
+        {
+            v_min = _mm_min_pd(v_min, _mm_loadu_pd(mins + i));
+            v_max = _mm_max_pd(v_max, _mm_loadu_pd(maxs + i));
+        }
+
+        double lanes[2];
+
+        _mm_storeu_pd(lanes, v_min);
+        min = qMin(min, qMin(lanes[0], lanes[1]));
+
+        _mm_storeu_pd(lanes, v_max);
+        max = qMax(max, qMax(lanes[0], lanes[1]));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        min = qMin(min, mins[i]);
+        max = qMax(max, maxs[i]);
+    }
+}
+
+
+bool ChartData::columnsRange(const QVector<double> &mins, const QVector<double> &maxs,
+                             int firstColumn, int lastColumn, double &min, double &max) const
+{
+    firstColumn = qMax(firstColumn, 0);
+    lastColumn = qMin(lastColumn, m_columns - 1);
+
+    if (!m_rows || firstColumn > lastColumn)
+        return false;
+
+    int first = slot(firstColumn), last = slot(lastColumn);
+
+    min = mins.at(first);
+    max = maxs.at(first);
+
+    if (first <= last)
+    {
+        reduceRange(mins.constData() + first, maxs.constData() + first, last - first + 1, min, max);
+    }
+    else
+    {
+        reduceRange(mins.constData() + first, maxs.constData() + first, m_capacity - first, min, max);
+        reduceRange(mins.constData(), maxs.constData(), last + 1, min, max);
+    }
+
+    return true;
+}
+
+
+void ChartData::summarySlots(int row, int firstSlot, int lastSlot,
+                             double &min, double &max, double &sum) const
+{
+    int c = firstSlot;
+    int end = lastSlot + 1;
+
+    while (c < end)
+    {
+        // the largest bucket starting at c and fitting into the rest of the range
+        int k = 0;
+        while (k < m_levels.count() && !(c & ((2 << k) - 1)) && c + (2 << k) <= end)
+            k++;
+
+        if (k == 0)
+        {
+            double v = m_values.at(c * m_rows + row);
+            min = qMin(min, v);
+            max = qMax(max, v);
+            sum += v;
+
+            c++;
+            continue;
+        }
+
+        const Level &level = m_levels.at(k - 1);
+        int index = (c >> k) * m_rows + row;
+
+        min = qMin(min, level.min.at(index));
+        max = qMax(max, level.max.at(index));
+        sum += level.sum.at(index);
+
+        c += 1 << k;
+    }
+}
+
+
+void ChartData::readColumn(const QAbstractItemModel *model, int column, int top, int bottom)
+{
+    int s = slot(column);
+
+    // styles of the rows are read once more
+    if (m_cellStylesEnabled)
+    {
+        QVector<CellStyle> &styles = m_cellStyles[s];
+
+        for (int i = styles.count() - 1; i >= 0; i--)
+        {
+            if (styles.at(i).row >= top && styles.at(i).row <= bottom)
+                styles.remove(i);
+        }
+    }
+
+    for (int r = top; r <= bottom; r++)
+    {
+        readValue(model, model->index(r, column), s);
+    }
+
+    updateColumn(s);
+}
+
+
+void ChartData::readValue(const QAbstractItemModel *model, const QModelIndex &index, int slot)
+{
+    m_values.data()[slot * m_rows + index.row()] = model->data(index, Qt::EditRole).toDouble();
+
+    if (!m_cellStylesEnabled)
+        return;
+
+    QVariant brush(model->data(index, Qt::BackgroundRole));
+    QVariant textColor(model->data(index, Qt::ForegroundRole));
+
+    if (!brush.isValid() && !textColor.isValid())
+        return;
+
+    CellStyle style;
+    style.row = index.row();
+    style.brush = brush;
+    style.textColor = textColor;
+
+    m_cellStyles[slot].append(style);
+}
+
+
+void ChartData::reserve(int columns)
+{
+    if (columns <= m_capacity)
+        return;
+
+    int capacity = qMax(columns, m_capacity * 2);
+
+    // unroll the ring into the new storage
+    QVector<double> values(capacity * m_rows);
+    QVector<double> stacked(capacity * m_rows);
+    QVector<double> positive(capacity);
+    QVector<double> negative(capacity);
+    QVector<double> minimum(capacity);
+    QVector<double> maximum(capacity);
+
+    for (int c = 0; c < m_columns; c++)
+    {
+        int s = slot(c);
+
+        memcpy(values.data() + c * m_rows, m_values.constData() + s * m_rows, m_rows * sizeof(double));
+        memcpy(stacked.data() + c * m_rows, m_stacked.constData() + s * m_rows, m_rows * sizeof(double));
+
+        positive[c] = m_positive.at(s);
+        negative[c] = m_negative.at(s);
+        minimum[c] = m_minimum.at(s);
+        maximum[c] = m_maximum.at(s);
+    }
+
+    m_values = values;
+    m_stacked = stacked;
+    m_positive = positive;
+    m_negative = negative;
+    m_minimum = minimum;
+    m_maximum = maximum;
+
+    if (m_cellStylesEnabled)
+    {
+        QVector<QVector<CellStyle> > styles(capacity);
+
+        for (int c = 0; c < m_columns; c++)
+            styles[c] = m_cellStyles.at(slot(c));
+
+        m_cellStyles = styles;
+    }
+
+    m_capacity = capacity;
+    m_first = 0;
+
+    m_levels.clear();
+    updatePyramid(0, m_columns - 1);
+}
+
+
+void ChartData::updateColumn(int slot)
+{
+    const double *v = m_values.constData() + slot * m_rows;
+    double *s = m_stacked.data() + slot * m_rows;
+
+    double pos = 0, neg = 0;
+
+    for (int r = 0; r < m_rows; r++)
+    {
+        if (v[r] < 0)
+        {
+            neg += v[r];
+            s[r] = neg;
+        }
+        else
+        {
+            pos += v[r];
+            s[r] = pos;
+        }
+    }
+
+    m_positive[slot] = pos;
+    m_negative[slot] = neg;
+
+    double min = 0, max = 0;
+    if (m_rows)
+    {
+        min = max = v[0];
+        reduceRange(v, v, m_rows, min, max);
+    }
+
+    m_minimum[slot] = min;
+    m_maximum[slot] = max;
+}
+
+
+void ChartData::updatePyramid(int firstSlot, int lastSlot)
+{
+    if (!m_pyramid || !m_rows)
+        return;
+
+    // the levels contain complete buckets only
+    int levels = 0;
+    while ((m_capacity >> (levels + 1)) > 0)
+        levels++;
+
+    m_levels.resize(levels);
+
+    for (int k = 0; k < levels; k++)
+    {
+        Level &level = m_levels[k];
+
+        int buckets = m_capacity >> (k + 1);
+        level.min.resize(buckets * m_rows);
+        level.max.resize(buckets * m_rows);
+        level.sum.resize(buckets * m_rows);
+
+        // buckets containing the changed slots
+        int first = firstSlot >> (k + 1);
+        int last = qMin(lastSlot >> (k + 1), buckets - 1);
+
+        for (int b = first; b <= last; b++)
+        {
+            double *mins = level.min.data() + b * m_rows;
+            double *maxs = level.max.data() + b * m_rows;
+            double *sums = level.sum.data() + b * m_rows;
+
+            // a bucket joins two buckets of the previous level (or two slots)
+            const double *min1, *min2, *max1, *max2, *sum1, *sum2;
+
+            if (k == 0)
+            {
+                min1 = max1 = sum1 = m_values.constData() + b * 2 * m_rows;
+                min2 = max2 = sum2 = min1 + m_rows;
+            }
+            else
+            {
+                const Level &prev = m_levels.at(k - 1);
+                min1 = prev.min.constData() + b * 2 * m_rows;
+                max1 = prev.max.constData() + b * 2 * m_rows;
+                sum1 = prev.sum.constData() + b * 2 * m_rows;
+                min2 = min1 + m_rows;
+                max2 = max1 + m_rows;
+                sum2 = sum1 + m_rows;
+            }
+
+            for (int r = 0; r < m_rows; r++)
+            {
+                mins[r] = qMin(min1[r], min2[r]);
+                maxs[r] = qMax(max1[r], max2[r]);
+                sums[r] = sum1[r] + sum2[r];
+            }
+        }
+    }
+}
+
+
+} // namespace
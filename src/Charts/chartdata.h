@@ -0,0 +1,184 @@
+#ifndef CHARTDATA_H
+#define CHARTDATA_H
+
+
+#include <QVector>
+#include <QVariant>
+
+#include <QtCore/QAbstractItemModel>
+
+
+namespace QSint
+{
+
+
+/**
+    \brief Numeric snapshot of the chart data model.
+    \since 0.2.3
+
+    Class keeps the values of the model (taken with Qt::EditRole) in a contiguous
+    column-major array of doubles, so the values of a single model column
+    are placed one after another. The columns are kept in a ring, so removing of the first
+    columns and appending of the new ones (see scroll()) costs nothing for the rest of the data.
+
+    Besides of the values, the stacked values (running sums of the values having the same sign)
+    and the sums of positive and negative values are kept per column, as well as the minimum
+    and the maximum. They are updated only for the columns touched by update() or appended
+    by scroll(), so valueRange() and stackedRange() of a column range reduce one value per column.
+
+    Optionally (see setPyramidEnabled()), minimums, maximums and sums of the values of every row
+    are kept for the aligned power-of-two column ranges (2, 4, 8... columns). Then summary()
+    of any column range costs O(log(columnCount())) instead of O(columnCount()).
+    The pyramid takes about 3 doubles per value, it is updated incrementally by update().
+
+    Optionally (see setCellStylesEnabled()), own brushes and text colors of the values
+    (Qt::BackgroundRole and Qt::ForegroundRole of the model) are kept as well. They are read
+    together with the values, so only the changed cells are read again.
+
+    It is used by the plotters to avoid calling QAbstractItemModel::data() while painting.
+*/
+class ChartData
+{
+public:
+    ChartData();
+
+    /// Reads all the values of \a model. If \a model is NULL, the snapshot is cleared.
+    void read(const QAbstractItemModel *model);
+    /// Re-reads the values of \a model from \a top to \a bottom rows and from \a left to \a right columns.
+    /// Model is supposed to have the same dimensions as the snapshot.
+    void update(const QAbstractItemModel *model, int top, int left, int bottom, int right);
+    /// Removes \a removed first columns and appends \a added last columns of \a model.
+    /// Model is supposed to have the same number of rows as the snapshot.
+    void scroll(const QAbstractItemModel *model, int removed, int added);
+    /// Clears the snapshot.
+    void clear();
+
+    /// Retrieves number of the rows.
+    inline int rowCount() const { return m_rows; }
+    /// Retrieves number of the columns.
+    inline int columnCount() const { return m_columns; }
+    /// Returns true if the snapshot contains no values.
+    inline bool isEmpty() const { return m_values.isEmpty(); }
+
+    /// Retrieves value at \a row and \a column.
+    inline double value(int row, int column) const
+    { return m_values.at(slot(column) * m_rows + row); }
+
+    /// Retrieves pointer to the rowCount() values of \a column.
+    inline const double* column(int column) const
+    { return m_values.constData() + slot(column) * m_rows; }
+
+    /// Retrieves stacked value at \a row and \a column, i.e. sum of the values of \a column
+    /// from the first row up to \a row (inclusive) having the same sign as the value at \a row.
+    inline double stackedValue(int row, int column) const
+    { return m_stacked.at(slot(column) * m_rows + row); }
+
+    /// Retrieves pointer to the rowCount() stacked values of \a column.
+    inline const double* stackedColumn(int column) const
+    { return m_stacked.constData() + slot(column) * m_rows; }
+
+    /// Retrieves sum of the positive values of \a column.
+    inline double positiveTotal(int column) const
+    { return m_positive.at(slot(column)); }
+
+    /// Retrieves sum of the negative values of \a column.
+    inline double negativeTotal(int column) const
+    { return m_negative.at(slot(column)); }
+
+    /// Retrieves minimum of the values of \a column.
+    inline double columnMinimum(int column) const
+    { return m_minimum.at(slot(column)); }
+
+    /// Retrieves maximum of the values of \a column.
+    inline double columnMaximum(int column) const
+    { return m_maximum.at(slot(column)); }
+
+    /** Retrieves minimum \a min and maximum \a max of the values
+        from \a firstColumn to \a lastColumn (inclusive).
+        Returns false (and leaves \a min and \a max untouched) if there are no such values.
+        \sa stackedRange()
+    */
+    bool valueRange(int firstColumn, int lastColumn, double &min, double &max) const;
+
+    /** Retrieves range of the stacked values from \a firstColumn to \a lastColumn (inclusive):
+        the smallest negativeTotal() to \a min and the largest positiveTotal() to \a max.
+        Returns false (and leaves \a min and \a max untouched) if there are no such values.
+        \sa valueRange()
+    */
+    bool stackedRange(int firstColumn, int lastColumn, double &min, double &max) const;
+
+    /// Own style of a value, taken from the model.
+    struct CellStyle
+    {
+        int row;
+        /// Qt::BackgroundRole data, or invalid
+        QVariant brush;
+        /// Qt::ForegroundRole data, or invalid
+        QVariant textColor;
+    };
+
+    /// Enables or disables keeping of the own styles of the values (disabled by default).
+    /// The styles are read with the values, i.e. by the next read() or update().
+    void setCellStylesEnabled(bool on);
+    /// Returns true if the own styles of the values are kept. \sa setCellStylesEnabled()
+    inline bool isCellStylesEnabled() const { return m_cellStylesEnabled; }
+    /// Retrieves own style of the value at \a row and \a column, or NULL if the value has none.
+    const CellStyle* cellStyle(int row, int column) const;
+
+    /// Enables or disables keeping of the min/max/sum pyramid (disabled by default).
+    void setPyramidEnabled(bool on);
+    /// Returns true if the min/max/sum pyramid is kept. \sa setPyramidEnabled()
+    inline bool isPyramidEnabled() const { return m_pyramid; }
+
+    /// Retrieves minimum, maximum and sum of the values of \a row
+    /// from \a firstColumn to \a lastColumn (inclusive).
+    void summary(int row, int firstColumn, int lastColumn,
+                 double &min, double &max, double &sum) const;
+
+protected:
+    /// Retrieves index of the storage slot keeping \a column.
+    inline int slot(int column) const
+    { int s = m_first + column; return s < m_capacity ? s : s - m_capacity; }
+
+    void readColumn(const QAbstractItemModel *model, int column, int top, int bottom);
+    /// Reads the value at \a index of \a model into the storage \a slot.
+    void readValue(const QAbstractItemModel *model, const QModelIndex &index, int slot);
+    void reserve(int columns);
+
+    // following methods take slots, not columns
+    void updateColumn(int slot);
+    void updatePyramid(int firstSlot, int lastSlot);
+    void summarySlots(int row, int firstSlot, int lastSlot,
+                      double &min, double &max, double &sum) const;
+    /// Reduces the per-slot \a mins and \a maxs of the columns from \a firstColumn to \a lastColumn.
+    bool columnsRange(const QVector<double> &mins, const QVector<double> &maxs,
+                      int firstColumn, int lastColumn, double &min, double &max) const;
+
+    int m_rows, m_columns;
+    /// number of the column slots and the slot of the first column
+    int m_capacity, m_first;
+
+    QVector<double> m_values;
+    QVector<double> m_stacked;
+    QVector<double> m_positive, m_negative;
+    QVector<double> m_minimum, m_maximum;
+
+    /// Values of the pyramid level: bucket by bucket, every bucket contains m_rows values.
+    struct Level
+    {
+        QVector<double> min, max, sum;
+    };
+
+    bool m_cellStylesEnabled;
+    /// Own styles of the values, per slot (empty if they are not kept).
+    QVector<QVector<CellStyle> > m_cellStyles;
+
+    bool m_pyramid;
+    /// m_levels[k] keeps the buckets of 2^(k+1) slots.
+    QVector<Level> m_levels;
+};
+
+
+} // namespace
+
+#endif // CHARTDATA_H
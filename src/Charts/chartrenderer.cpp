@@ -0,0 +1,327 @@
+#include "chartrenderer.h"
+#include "barchartplotter.h"
+#include "piechart.h"
+#include "ringchart.h"
+#include "axisbase.h"
+
+#include <QPainter>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QMutex>
+#include <QFontDatabase>
+
+#if QT_VERSION >= 0x050000
+#include <QPdfWriter>
+#endif
+
+#if QT_VERSION >= 0x050300
+#include <QPageLayout>
+#endif
+
+
+namespace QSint
+{
+
+
+/// State of renderBatch() shared with the worker threads.
+struct BatchState
+{
+    explicit BatchState(int slots) : available(slots), written(0) {}
+
+    /// limits number of the charts waiting for rendering
+    QSemaphore available;
+
+    QMutex mutex;
+    /// rendered copies of the plotter to be deleted in the calling thread
+    QList<PlotterBase*> finished;
+    int written;
+};
+
+
+/// Writes laid out copy of the chart into the file in the worker thread.
+class ChartRenderer::BatchTask : public QRunnable
+{
+public:
+    BatchTask(PlotterBase *snapshot, const QString &fileName, BatchState *state) :
+        m_snapshot(snapshot),
+        m_fileName(fileName),
+        m_state(state)
+    {
+    }
+
+    virtual void run()
+    {
+        bool ok = writeFile(m_snapshot, m_fileName);
+
+        m_state->mutex.lock();
+
+        m_state->finished.append(m_snapshot);
+        if (ok)
+            m_state->written++;
+
+        m_state->mutex.unlock();
+
+        m_state->available.release();
+    }
+
+private:
+    PlotterBase *m_snapshot;
+    QString m_fileName;
+    BatchState *m_state;
+};
+
+
+ChartRenderer::ChartRenderer(ChartType type) :
+    m_type(type),
+    m_model(0),
+    m_size(640, 480),
+    m_plotter(0)
+{
+    createPlotter();
+}
+
+
+ChartRenderer::~ChartRenderer()
+{
+    delete m_plotter;
+}
+
+
+void ChartRenderer::setChartType(ChartType type)
+{
+    if (m_type == type)
+        return;
+
+    bool bar = (m_type <= Trend && type <= Trend);
+
+    m_type = type;
+
+    // bar charts keep their setup
+    if (bar)
+        static_cast<BarChartPlotter*>(m_plotter)->setBarType(BarChartPlotter::BarChartType(m_type));
+    else
+        createPlotter();
+}
+
+
+void ChartRenderer::setModel(QAbstractItemModel *model)
+{
+    m_model = model;
+
+    m_plotter->setModel(model);
+}
+
+
+void ChartRenderer::setSize(const QSize &size)
+{
+    m_size = size;
+}
+
+
+void ChartRenderer::setPaintScheme(const PaintScheme &scheme)
+{
+    m_scheme = scheme;
+
+    applyScheme();
+}
+
+
+void ChartRenderer::createPlotter()
+{
+    delete m_plotter;
+
+    switch (m_type)
+    {
+    case Pie:
+        m_plotter = new PieChart();
+        break;
+
+    case Ring:
+        m_plotter = new RingChart();
+        break;
+
+    default:
+        BarChartPlotter *plotter = new BarChartPlotter();
+        plotter->setBarType(BarChartPlotter::BarChartType(m_type));
+        m_plotter = plotter;
+        break;
+
+    } // switch
+
+    m_plotter->setModel(m_model);
+
+    applyScheme();
+}
+
+
+void ChartRenderer::applyScheme()
+{
+    m_plotter->setBorderPen(m_scheme.basePen);
+    m_plotter->setBackground(m_scheme.baseBrush);
+    m_plotter->setFont(m_scheme.itemTextFont);
+
+    AxisBase *axes[] = { m_plotter->axisX(), m_plotter->axisY() };
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (!axes[i])
+            continue;
+
+        axes[i]->setFont(m_scheme.axisTextFont);
+
+        if (m_scheme.axisTextColor.isValid())
+            axes[i]->setTextColor(m_scheme.axisTextColor);
+    }
+}
+
+
+void ChartRenderer::prepare(const QSize &size)
+{
+    // hidden widget does not get resize events
+    if (m_plotter->size() != size)
+    {
+        m_plotter->resize(size);
+        m_plotter->scheduleUpdate();
+    }
+
+    m_plotter->ensureLayout();
+}
+
+
+void ChartRenderer::paint(PlotterBase *plotter, QPainter &p)
+{
+    plotter->renderLayers(p);
+    plotter->drawForeground(p);
+}
+
+
+bool ChartRenderer::writeFile(PlotterBase *plotter, const QString &fileName)
+{
+#if QT_VERSION >= 0x050000
+    if (QFileInfo(fileName).suffix().toLower() == QLatin1String("pdf"))
+    {
+        QPdfWriter pdf(fileName);
+
+        // a pixel of the chart is a point of the page
+        pdf.setResolution(72);
+
+#if QT_VERSION >= 0x050300
+        pdf.setPageLayout(QPageLayout(QPageSize(QSizeF(plotter->size()), QPageSize::Point),
+                                      QPageLayout::Portrait, QMarginsF()));
+#else
+        pdf.setPageSizeMM(QSizeF(plotter->width() * 25.4 / 72, plotter->height() * 25.4 / 72));
+
+        QPagedPaintDevice::Margins margins = { 0, 0, 0, 0 };
+        pdf.setMargins(margins);
+#endif
+
+        QPainter p;
+        if (!p.begin(&pdf))
+            return false;
+
+        paint(plotter, p);
+
+        return p.end();
+    }
+#endif
+
+    QImage image(plotter->size(), QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull())
+        return false;
+
+    // the background could be translucent
+    image.fill(Qt::transparent);
+
+    QPainter p(&image);
+    paint(plotter, p);
+    p.end();
+
+    return image.save(fileName);
+}
+
+
+void ChartRenderer::render(QPaintDevice *device)
+{
+    prepare(m_size);
+
+    QPainter p(device);
+    paint(m_plotter, p);
+}
+
+
+QImage ChartRenderer::renderImage(int bands)
+{
+    prepare(m_size);
+
+    return m_plotter->renderImage(m_size, bands);
+}
+
+
+bool ChartRenderer::renderToFile(const QString &fileName)
+{
+    prepare(m_size);
+
+    return writeFile(m_plotter, fileName);
+}
+
+
+int ChartRenderer::renderBatch(const QList<Job> &jobs, int threads)
+{
+    if (threads <= 0)
+        threads = QThread::idealThreadCount();
+
+    bool threaded = true;
+#if QT_VERSION >= 0x040800
+    threaded = QFontDatabase::supportsThreadedFontRendering();
+#endif
+
+    // a couple of charts per thread are laid out in advance
+    BatchState state(threads * 2);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    for (int i = 0; i < jobs.count(); i++)
+    {
+        const Job &job = jobs.at(i);
+
+        m_plotter->setModel(job.model);
+        prepare(job.size.isValid() ? job.size : m_size);
+
+        PlotterBase *snapshot = threaded ? m_plotter->clone() : 0;
+
+        if (!snapshot)
+        {
+            if (writeFile(m_plotter, job.fileName))
+                state.written++;
+
+            continue;
+        }
+
+        state.available.acquire();
+
+        // the copies are deleted in this thread
+        state.mutex.lock();
+        QList<PlotterBase*> finished(state.finished);
+        state.finished.clear();
+        state.mutex.unlock();
+
+        qDeleteAll(finished);
+
+        pool.start(new BatchTask(snapshot, job.fileName, &state));
+    }
+
+    pool.waitForDone();
+
+    qDeleteAll(state.finished);
+
+    m_plotter->setModel(m_model);
+
+    return state.written;
+}
+
+
+} // namespace
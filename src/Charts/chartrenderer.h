@@ -0,0 +1,143 @@
+#ifndef CHARTRENDERER_H
+#define CHARTRENDERER_H
+
+
+#include <QSize>
+#include <QString>
+#include <QList>
+#include <QImage>
+
+#include <QtCore/QAbstractItemModel>
+
+#include "paintscheme.h"
+
+
+class QPainter;
+class QPaintDevice;
+
+
+namespace QSint
+{
+
+
+class PlotterBase;
+
+
+/**
+    \brief Class rendering the charts without showing them (i.e. for the server side reporting).
+    \since 0.2.3
+
+    ChartRenderer paints a chart of the given type and size for a model into any QPaintDevice
+    (QImage, QPdfWriter, QSvgGenerator etc.) or into a file. The chart widget is created
+    internally and is never shown, so the renderer works with the "offscreen" platform plugin
+    as well (QApplication is still required).
+
+    The chart could be tuned via plotter() (i.e. ranges of the axes) and setPaintScheme().
+
+    renderBatch() renders many models into the files: the charts are laid out one by one
+    in the calling thread, and their copies are rasterized and written by the thread pool.
+*/
+class ChartRenderer
+{
+public:
+    /// \brief Defines type of the chart.
+    enum ChartType
+    {
+        /// BarChartPlotter of \a Stacked type
+        Stacked,
+        /// BarChartPlotter of \a Columns type
+        Columns,
+        /// BarChartPlotter of \a Trend type
+        Trend,
+        /// PieChart
+        Pie,
+        /// RingChart
+        Ring
+    };
+
+    /// \brief Single job of renderBatch().
+    struct Job
+    {
+        Job(QAbstractItemModel *jobModel = 0, const QString &jobFile = QString(), const QSize &jobSize = QSize()) :
+            model(jobModel), fileName(jobFile), size(jobSize)
+        {
+        }
+
+        /// model to be rendered
+        QAbstractItemModel *model;
+        /// file to write (format is defined by the suffix, "pdf" is supported since Qt 5)
+        QString fileName;
+        /// size of the chart, or invalid size to use size() of the renderer
+        QSize size;
+    };
+
+    explicit ChartRenderer(ChartType type = Stacked);
+    ~ChartRenderer();
+
+    /// Sets type of the chart to \a type.
+    /// The plotter is re-created if it is changed between bar charts and pie or ring ones.
+    void setChartType(ChartType type);
+    /// Retrieves type of the chart.
+    inline ChartType chartType() const { return m_type; }
+
+    /// Sets data model to \a model.
+    void setModel(QAbstractItemModel *model);
+    /// Retrieves data model or NULL if not set.
+    inline QAbstractItemModel* model() const { return m_model; }
+
+    /// Sets size of the chart to \a size (640x480 is the default).
+    void setSize(const QSize &size);
+    /// Retrieves size of the chart.
+    inline const QSize& size() const { return m_size; }
+
+    /// Sets pens, brushes and fonts of the chart from \a scheme.
+    void setPaintScheme(const PaintScheme &scheme);
+    /// Retrieves paint scheme of the chart.
+    inline const PaintScheme& paintScheme() const { return m_scheme; }
+
+    /// Retrieves the chart (never shown) for the detailed setup.
+    inline PlotterBase* plotter() const { return m_plotter; }
+
+    /// Paints the chart into \a device.
+    void render(QPaintDevice *device);
+    /// Renders the chart into an image (in parallel bands, see PlotterBase::renderImage()).
+    QImage renderImage(int bands = 0);
+    /// Writes the chart into the file \a fileName. Returns true on success.
+    bool renderToFile(const QString &fileName);
+
+    /** Renders the models of \a jobs into their files using \a threads worker threads
+        (0 means one thread per CPU core). Type, paint scheme and setup of the chart
+        are the same for all the jobs. Returns number of the files written successfully.
+    */
+    int renderBatch(const QList<Job> &jobs, int threads = 0);
+
+protected:
+    /// Creates the plotter of the current type.
+    void createPlotter();
+    /// Applies the paint scheme to the plotter.
+    void applyScheme();
+    /// Updates the layout of the plotter of \a size.
+    void prepare(const QSize &size);
+
+    /// Paints laid out \a plotter using painter \a p.
+    static void paint(PlotterBase *plotter, QPainter &p);
+    /// Writes laid out \a plotter into the file \a fileName.
+    static bool writeFile(PlotterBase *plotter, const QString &fileName);
+
+    class BatchTask;
+
+    ChartType m_type;
+    QAbstractItemModel *m_model;
+    QSize m_size;
+    PaintScheme m_scheme;
+
+    PlotterBase *m_plotter;
+
+private:
+    Q_DISABLE_COPY(ChartRenderer)
+};
+
+
+} // namespace
+
+#endif // CHARTRENDERER_H
@@ -0,0 +1,17 @@
+#ifndef CHARTSIMD_P_H
+#define CHARTSIMD_P_H
+
+
+// Instruction set of the vectorized loops of the charts: the widest one enabled by the compiler.
+// SSE2 is always available on x86-64; on 32-bit x86 it needs -msse2 or /arch:SSE2.
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#  define QSINT_CHARTS_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define QSINT_CHARTS_SSE2
+#endif
+
+
+#endif // CHARTSIMD_P_H
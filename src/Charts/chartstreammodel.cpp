@@ -0,0 +1,210 @@
+#include "chartstreammodel.h"
+
+#include <QMetaObject>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+namespace QSint
+{
+
+
+ChartStreamModel::ChartStreamModel(int rows, int capacity, QObject *parent) :
+    QAbstractTableModel(parent),
+    m_rows(qMax(0, rows)),
+    m_capacity(qMax(1, capacity)),
+    m_first(0),
+    m_count(0),
+    m_removed(0)
+{
+    m_values.resize(m_rows * m_capacity);
+    m_rowHeaders.resize(m_rows);
+}
+
+
+ChartStreamModel::~ChartStreamModel()
+{
+    Sample *sample = m_queue.fetchAndStoreAcquire(0);
+
+    while (sample)
+    {
+        Sample *next = sample->next;
+        free(sample);
+        sample = next;
+    }
+}
+
+
+void ChartStreamModel::append(const double *values)
+{
+    append(values, 1);
+}
+
+
+void ChartStreamModel::append(const double *values, int count)
+{
+    if (count <= 0 || !m_rows)
+        return;
+
+    // only the last samples are kept
+    if (count >= m_capacity)
+    {
+        beginResetModel();
+
+        m_removed += m_count + count - m_capacity;
+        m_first = 0;
+        m_count = m_capacity;
+
+        memcpy(m_values.data(), values + (count - m_capacity) * m_rows, m_values.size() * sizeof(double));
+
+        endResetModel();
+        return;
+    }
+
+    int removed = qMax(0, m_count + count - m_capacity);
+    if (removed)
+    {
+        beginRemoveColumns(QModelIndex(), 0, removed - 1);
+
+        m_first = slot(removed);
+        m_count -= removed;
+        m_removed += removed;
+
+        endRemoveColumns();
+    }
+
+    beginInsertColumns(QModelIndex(), m_count, m_count + count - 1);
+
+    for (int c = 0; c < count; c++, values += m_rows)
+    {
+        memcpy(m_values.data() + slot(m_count++) * m_rows, values, m_rows * sizeof(double));
+    }
+
+    endInsertColumns();
+
+    emit columnsScrolled(removed, count);
+}
+
+
+void ChartStreamModel::push(const double *values)
+{
+    Sample *sample = (Sample*) malloc(sizeof(Sample) + m_rows * sizeof(double));
+    if (!sample)
+        return;
+
+    memcpy(sample + 1, values, m_rows * sizeof(double));
+
+    Sample *head;
+    do
+    {
+#if QT_VERSION >= 0x050000
+        head = m_queue.loadAcquire();
+#else
+        head = m_queue;
+#endif
+        sample->next = head;
+    }
+    while (!m_queue.testAndSetRelease(head, sample));
+
+    // the queue was empty, so nobody has requested flushing yet
+    if (!head)
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+}
+
+
+void ChartStreamModel::flush()
+{
+    Sample *sample = m_queue.fetchAndStoreAcquire(0);
+    if (!sample)
+        return;
+
+    int count = 0;
+    for (Sample *s = sample; s; s = s->next)
+        count++;
+
+    // the queue keeps the last sample first
+    m_batch.resize(count * m_rows);
+
+    double *values = m_batch.data() + count * m_rows;
+
+    while (sample)
+    {
+        values -= m_rows;
+        memcpy(values, sample + 1, m_rows * sizeof(double));
+
+        Sample *next = sample->next;
+        free(sample);
+        sample = next;
+    }
+
+    append(m_batch.constData(), count);
+}
+
+
+void ChartStreamModel::clear()
+{
+    beginResetModel();
+
+    m_first = m_count = 0;
+    m_removed = 0;
+
+    endResetModel();
+}
+
+
+int ChartStreamModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+
+int ChartStreamModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+
+QVariant ChartStreamModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows || index.column() >= m_count)
+        return QVariant();
+
+    if (role == Qt::DisplayRole || role == Qt::EditRole)
+        return value(index.row(), index.column());
+
+    return QVariant();
+}
+
+
+QVariant ChartStreamModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal)
+    {
+        if (role == Qt::DisplayRole && section >= 0 && section < m_count)
+            return m_removed + section;
+
+        return QVariant();
+    }
+
+    if (section < 0 || section >= m_rows)
+        return QVariant();
+
+    return m_rowHeaders.at(section).value(role);
+}
+
+
+bool ChartStreamModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+    if (orientation != Qt::Vertical || section < 0 || section >= m_rows)
+        return false;
+
+    m_rowHeaders[section][role] = value;
+
+    emit headerDataChanged(orientation, section, section);
+
+    return true;
+}
+
+
+} // namespace
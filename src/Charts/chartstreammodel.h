@@ -0,0 +1,112 @@
+#ifndef CHARTSTREAMMODEL_H
+#define CHARTSTREAMMODEL_H
+
+
+#include <QVector>
+#include <QMap>
+#include <QAtomicPointer>
+
+#include <QtCore/QAbstractTableModel>
+
+
+namespace QSint
+{
+
+
+/**
+    \brief Table model keeping a sliding window of the real-time data.
+    \since 0.2.3
+
+    Every model row represents a single data series, every model column - a single sample
+    of all the series. New samples are added via append(). The model keeps at most capacity()
+    last samples: when it is full, appending of the new samples removes the oldest ones.
+
+    The values are kept in a ring buffer, so appending and removing of a sample do not
+    depend on the number of the samples kept.
+
+    Besides of the standard QAbstractItemModel signals, columnsScrolled() is emitted after
+    every change of the samples. PlotterBase handles it instead of the column signals:
+    it updates only the appended columns of its data and scrolls its cached content.
+
+    Samples acquired by the other threads could be passed via push(). It is thread-safe
+    and lock-free: the samples are queued and appended in one step by flush(),
+    which is invoked in the thread of the model when the queue is not empty anymore.
+    So a burst of the samples costs a single update of the views.
+
+    Horizontal header contains the number of the sample since the model creation (or clear()).
+    Vertical header data (i.e. names and colors of the series) could be set via setHeaderData().
+*/
+class ChartStreamModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    /// Creates the model with \a rows data series keeping at most \a capacity samples.
+    explicit ChartStreamModel(int rows, int capacity, QObject *parent = 0);
+    virtual ~ChartStreamModel();
+
+    /// Retrieves maximal number of the samples kept by the model.
+    inline int capacity() const { return m_capacity; }
+
+    /// Appends the sample of rowCount() \a values.
+    void append(const double *values);
+    /// Appends \a count samples of rowCount() \a values each (placed sample by sample).
+    void append(const double *values, int count);
+
+    /// Queues the sample of rowCount() \a values to be appended by flush().
+    /// Could be called from any thread.
+    void push(const double *values);
+
+    /// Removes all the samples.
+    void clear();
+
+    /// Retrieves value of the series \a row in the sample \a column.
+    inline double value(int row, int column) const
+    { return m_values.at(slot(column) * m_rows + row); }
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    virtual bool setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role = Qt::EditRole);
+
+public Q_SLOTS:
+    /// Appends all the samples queued by push().
+    void flush();
+
+Q_SIGNALS:
+    /// Emitted after \a removed first columns have been removed and \a added columns have been appended.
+    void columnsScrolled(int removed, int added);
+
+protected:
+    inline int slot(int column) const
+    { int s = m_first + column; return s < m_capacity ? s : s - m_capacity; }
+
+    int m_rows, m_capacity;
+
+    /// ring of m_capacity samples, m_rows values each
+    QVector<double> m_values;
+    /// slot of the first sample and the number of the samples
+    int m_first, m_count;
+    /// number of the samples removed since the model creation
+    qint64 m_removed;
+
+    QVector<QMap<int, QVariant> > m_rowHeaders;
+
+    /// Sample queued by push(), its values follow the structure.
+    struct Sample
+    {
+        Sample *next;
+    };
+
+    /// queued samples, the last pushed one first
+    QAtomicPointer<Sample> m_queue;
+    /// samples taken from the queue by flush()
+    QVector<double> m_batch;
+};
+
+
+} // namespace
+
+#endif // CHARTSTREAMMODEL_H
@@ -1,16 +1,16 @@
-#include "paintscheme.h"
-
-
-namespace QSint
-{
-
-
-PaintScheme::PaintScheme()
-{
-    basePen = QPen(Qt::gray);
-    baseBrush = QBrush(Qt::lightGray);
-}
-
-
-}
-
+#include "paintscheme.h"
+
+
+namespace QSint
+{
+
+
+PaintScheme::PaintScheme()
+{
+    basePen = QPen(Qt::gray);
+    baseBrush = QBrush(Qt::lightGray);
+}
+
+
+}
+
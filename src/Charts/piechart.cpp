@@ -1,217 +1,353 @@
-#include <qmath.h>
-
-#include "piechart.h"
-
-
-namespace QSint
-{
-
-
-PieChart::PieChart(QWidget *parent) :
-    PlotterBase(parent)
-{
-    setAntiAliasing(true);
-
-    m_index = 0;
-
-    m_margin = 3;
-}
-
-
-void PieChart::setMargin(int margin)
-{
-    if (margin < 0 || margin == m_margin)
-        return;
-
-    m_margin = margin;
-
-    scheduleUpdate();
-}
-
-
-void PieChart::setActiveIndex(int index)
-{
-    if (m_index == index)
-        return;
-
-    m_index = 0;
-
-    scheduleUpdate();
-
-    if (!m_model)
-        return;
-
-    if (index >= 0 && index < m_model->columnCount())
-        m_index = index;
-}
-
-
-void PieChart::setActiveIndex(const QModelIndex &index)
-{
-    if (index.isValid())
-        setActiveIndex(index.column());
-}
-
-
-void PieChart::drawContent(QPainter &p)
-{
-    int w = width() - m_margin*2;
-    int h = height() - m_margin*2;
-
-    int wh = qMin(w,h);
-    int wh2 = wh / 2;
-
-    int dx2 = (w - wh) / 2;
-    int dy2 = (h - wh) / 2;
-
-    QRect pieRect = QRect(dx2+m_margin, dy2+m_margin, wh, wh);
-
-    p.drawEllipse(pieRect);
-
-    if (!m_model)
-        return;
-
-    int row_count = m_model->rowCount();
-    if (!row_count)
-        return;
-
-    int count = m_model->columnCount();
-    if (!count)
-        return;
-
-    if (m_index < 0 || m_index >= count)
-        return;
-
-    // check if need to draw highlight
-    bool checkHighlight = false;
-    double mouseAngle = 0;
-
-    // check if we're inside piechart at all
-    if (!m_mousePos.isNull() && pieRect.contains(m_mousePos))
-    {
-        // Determine the distance from the center point of the pie chart.
-        double cx = m_mousePos.x() - dx2 - wh2;
-        double cy = dy2 + wh2 - m_mousePos.y();
-        double dr = pow(pow(cx, 2) + pow(cy, 2), 0.5);
-        if (!(dr == 0 || dr > wh2)){
-            // Determine the angle of the point.
-            mouseAngle = (180 / M_PI) * acos(cx/dr);
-            if (cy < 0)
-                mouseAngle = 360 - mouseAngle;
-
-            checkHighlight = true;
-        }
-    }
-
-    // draw pie chart
-    p.setFont(m_font);
-
-    int c = m_index;
-
-    double totalValue = 0;
-
-    for (int r = 0; r < row_count; r++)
-    {
-        const QModelIndex index(m_model->index(r, c));
-        double value = m_model->data(index).toDouble();
-
-        if (value > 0.0)
-            totalValue += value;
-    }
-
-    double startAngle = 0.0;
-    bool isHighlighted = false;
-    double angleHl1, angleHl2, valueHl;
-    QModelIndex indexHl;
-
-    for (int r = 0; r < row_count; r++)
-    {
-        const QModelIndex index(m_model->index(r, c));
-        double value = m_model->data(index).toDouble();
-
-        if (value > 0.0) {
-            double angle = 360 * value / totalValue;
-
-            if (checkHighlight && startAngle <= mouseAngle && mouseAngle <= (startAngle + angle))
-            {
-                isHighlighted = true;
-                angleHl1 = startAngle;
-                angleHl2 = angle;
-                valueHl = value;
-                indexHl = index;
-            }
-            else
-            {
-                drawSegment(p, pieRect, index, value, startAngle, angle, false);
-                drawValue(p, pieRect, index, value, startAngle, angle, false);
-            }
-
-            startAngle += angle;
-        }
-    }
-
-    // highlight to be drawn over the other segments
-    if (isHighlighted)
-    {
-        setIndexUnderMouse(indexHl);
-
-        drawSegment(p, pieRect, indexHl, valueHl, angleHl1, angleHl2, true);
-        drawValue(p, pieRect, indexHl, valueHl, angleHl1, angleHl2, true);
-    }
-    else
-        setIndexUnderMouse(QModelIndex());
-}
-
-
-void PieChart::drawSegment(QPainter &p, const QRect& pieRect,
-                           const QModelIndex &index, double /*value*/,
-                           double angle1, double angle2,
-                           bool isHighlighted)
-{
-    int r = index.row();
-
-    if (isHighlighted)
-    {
-        p.setPen(m_hlPen);
-        p.setBrush(m_hlBrush);
-
-        p.drawPie(pieRect, int(angle1*16), int(angle2*16));
-    }
-    else
-    {
-        p.setPen(m_itemPen);
-
-        QBrush brush(qvariant_cast<QBrush>(m_model->headerData(r, Qt::Vertical, Qt::BackgroundRole)));
-        p.setBrush(brush);
-
-        p.drawPie(pieRect, int(angle1*16), int(angle2*16));
-    }
-}
-
-
-void PieChart::drawValue(QPainter &p, const QRect& pieRect,
-                           const QModelIndex &index, double value,
-                           double angle1, double angle2,
-                           bool isHighlighted)
-{
-    // text (angle CCW in radians)
-    double cr = pieRect.height()/4 + pieRect.height()/8;
-    double textAngle = (360 - angle1 - angle2/2) * M_PI / 180;
-    double tx = cr * cos(textAngle) + rect().center().x();
-    double ty = cr * sin(textAngle) + rect().center().y();
-
-    if (isHighlighted)
-    {
-        p.setPen(QPen(m_hlTextColor));
-    }
-    else
-    {
-        QPen pen(qvariant_cast<QColor>(m_model->headerData(index.row(), Qt::Vertical, Qt::ForegroundRole)));
-        p.setPen(pen);
-    }
-
-    p.drawText(tx, ty, formattedValue(value));
-}
-
-
-}
+#include <qmath.h>
+#include <typeinfo>
+
+#include "piechart.h"
+
+
+namespace QSint
+{
+
+
+PieChart::PieChart(QWidget *parent) :
+    PlotterBase(parent)
+{
+    setAntiAliasing(true);
+
+    m_index = 0;
+
+    m_margin = 3;
+}
+
+
+void PieChart::setMargin(int margin)
+{
+    if (margin < 0 || margin == m_margin)
+        return;
+
+    m_margin = margin;
+
+    scheduleUpdate();
+}
+
+
+void PieChart::setActiveIndex(int index)
+{
+    if (m_index == index)
+        return;
+
+    m_index = 0;
+
+    scheduleUpdate();
+
+    if (!m_model)
+        return;
+
+    if (index >= 0 && index < m_model->columnCount())
+        m_index = index;
+}
+
+
+void PieChart::setActiveIndex(const QModelIndex &index)
+{
+    if (index.isValid())
+        setActiveIndex(index.column());
+}
+
+
+QRect PieChart::pieRect() const
+{
+    int w = width() - m_margin*2;
+    int h = height() - m_margin*2;
+
+    int wh = qMin(w,h);
+
+    int dx2 = (w - wh) / 2;
+    int dy2 = (h - wh) / 2;
+
+    return QRect(dx2+m_margin, dy2+m_margin, wh, wh);
+}
+
+
+double PieChart::totalValue() const
+{
+    return m_data.positiveTotal(m_index);
+}
+
+
+void PieChart::calculateLayout()
+{
+    m_indexes.clear();
+
+    if (!m_model || m_index < 0 || m_index >= m_data.columnCount())
+        return;
+
+    // painting does not access the model
+    int row_count = m_data.rowCount();
+    m_indexes.resize(row_count);
+
+    for (int r = 0; r < row_count; r++)
+        m_indexes[r] = m_model->index(r, m_index);
+}
+
+
+PlotterBase* PieChart::clone() const
+{
+    // the copy of a subclass would not paint as the subclass does
+    if (typeid(*this) != typeid(PieChart))
+        return 0;
+
+    PieChart *chart = new PieChart();
+
+    chart->copyState(*this);
+
+    chart->m_index = m_index;
+    chart->m_margin = m_margin;
+    chart->m_indexes = m_indexes;
+
+    return chart;
+}
+
+
+void PieChart::drawContent(QPainter &p)
+{
+    QRect pieRect = this->pieRect();
+
+    p.drawEllipse(pieRect);
+
+    if (!m_model)
+        return;
+
+    int row_count = m_data.rowCount();
+    if (!row_count)
+        return;
+
+    int count = m_data.columnCount();
+    if (!count)
+        return;
+
+    if (m_index < 0 || m_index >= count || m_indexes.count() != row_count)
+        return;
+
+    // draw pie chart
+    p.setFont(m_font);
+
+    int c = m_index;
+
+    const double *values = m_data.column(c);
+
+    double totalValue = this->totalValue();
+
+    double startAngle = 0.0;
+
+    for (int r = 0; r < row_count; r++)
+    {
+        double value = values[r];
+
+        if (value > 0.0) {
+            const QModelIndex &index = m_indexes.at(r);
+
+            double angle = 360 * value / totalValue;
+
+            drawSegment(p, pieRect, index, value, startAngle, angle, false);
+            drawValue(p, pieRect, index, value, startAngle, angle, false);
+
+            startAngle += angle;
+        }
+    }
+}
+
+
+bool PieChart::segmentAngles(const QModelIndex &index, double &angle1, double &angle2) const
+{
+    if (!m_model || !index.isValid())
+        return false;
+
+    int c = index.column();
+    int hr = index.row();
+
+    if (c >= m_data.columnCount() || hr >= m_data.rowCount())
+        return false;
+
+    const double *values = m_data.column(c);
+
+    double totalValue = this->totalValue();
+
+    // sum the angles of the previous segments
+    angle1 = 0.0;
+
+    for (int r = 0; r < hr; r++)
+    {
+        double value = values[r];
+
+        if (value > 0.0)
+            angle1 += 360 * value / totalValue;
+    }
+
+    angle2 = 360 * values[hr] / totalValue;
+
+    return true;
+}
+
+
+void PieChart::drawHighlight(QPainter &p)
+{
+    double startAngle, angleHl;
+    if (!segmentAngles(m_indexUnderMouse, startAngle, angleHl))
+        return;
+
+    double valueHl = m_data.value(m_indexUnderMouse.row(), m_indexUnderMouse.column());
+
+    // highlight to be drawn over the other segments
+    p.setFont(m_font);
+
+    drawSegment(p, pieRect(), m_indexUnderMouse, valueHl, startAngle, angleHl, true);
+    drawValue(p, pieRect(), m_indexUnderMouse, valueHl, startAngle, angleHl, true);
+}
+
+
+QRect PieChart::highlightRect(const QModelIndex &index) const
+{
+    double angle1, angle2;
+    if (!segmentAngles(index, angle1, angle2))
+        return QRect();
+
+    QRect pieRect(this->pieRect());
+
+    // value text is drawn from its baseline
+    QFontMetrics fm(m_font);
+    QString text(formattedValue(m_data.value(index.row(), index.column())));
+    QPoint pos(valuePos(pieRect, angle1, angle2));
+
+    QRect textRect(pos.x(), pos.y() - fm.ascent(), fm.width(text), fm.height());
+
+    // pen width and antialiasing
+    return (pieSegmentRect(pieRect, angle1, angle2) | textRect).adjusted(-2, -2, 2, 2);
+}
+
+
+QModelIndex PieChart::indexAt(const QPoint &pos) const
+{
+    if (!m_model || pos.isNull())
+        return QModelIndex();
+
+    int row_count = m_data.rowCount();
+    int count = m_data.columnCount();
+
+    if (m_index < 0 || m_index >= count)
+        return QModelIndex();
+
+    int w = width() - m_margin*2;
+    int h = height() - m_margin*2;
+
+    int wh = qMin(w,h);
+    int wh2 = wh / 2;
+
+    int dx2 = (w - wh) / 2;
+    int dy2 = (h - wh) / 2;
+
+    // check if we're inside piechart at all
+    if (!pieRect().contains(pos))
+        return QModelIndex();
+
+    // Determine the distance from the center point of the pie chart.
+    double cx = pos.x() - dx2 - wh2;
+    double cy = dy2 + wh2 - pos.y();
+    double dr = pow(pow(cx, 2) + pow(cy, 2), 0.5);
+    if (dr == 0 || dr > wh2)
+        return QModelIndex();
+
+    // Determine the angle of the point.
+    double mouseAngle = (180 / M_PI) * acos(cx/dr);
+    if (cy < 0)
+        mouseAngle = 360 - mouseAngle;
+
+    const double *values = m_data.column(m_index);
+
+    double totalValue = this->totalValue();
+
+    double startAngle = 0.0;
+
+    for (int r = 0; r < row_count; r++)
+    {
+        double value = values[r];
+
+        if (value > 0.0) {
+            double angle = 360 * value / totalValue;
+
+            if (startAngle <= mouseAngle && mouseAngle <= (startAngle + angle))
+                return m_model->index(r, m_index);
+
+            startAngle += angle;
+        }
+    }
+
+    return QModelIndex();
+}
+
+
+void PieChart::drawSegment(QPainter &p, const QRect& pieRect,
+                           const QModelIndex &index, double /*value*/,
+                           double angle1, double angle2,
+                           bool isHighlighted)
+{
+    int r = index.row();
+
+    countSegments(1);
+
+    if (isHighlighted)
+    {
+        p.setPen(m_hlPen);
+        p.setBrush(m_hlBrush);
+
+        p.drawPie(pieRect, int(angle1*16), int(angle2*16));
+    }
+    else
+    {
+        p.setPen(m_itemPen);
+
+        p.setBrush(seriesStyle(r).brush);
+
+        p.drawPie(pieRect, int(angle1*16), int(angle2*16));
+    }
+}
+
+
+void PieChart::drawValue(QPainter &p, const QRect& pieRect,
+                           const QModelIndex &index, double value,
+                           double angle1, double angle2,
+                           bool isHighlighted)
+{
+    QPoint pos(valuePos(pieRect, angle1, angle2));
+
+    if (isHighlighted)
+    {
+        p.setPen(QPen(m_hlTextColor));
+    }
+    else
+    {
+        p.setPen(seriesStyle(index.row()).textPen);
+    }
+
+    countLabels(1);
+
+    // drawn by the rendering threads as well, so the text is not shared between them
+    QString &text = textBuffer();
+    formatValue(value, text);
+
+    p.drawText(pos, text);
+}
+
+
+QPoint PieChart::valuePos(const QRect& pieRect, double angle1, double angle2) const
+{
+    // text (angle CCW in radians)
+    double cr = pieRect.height()/4 + pieRect.height()/8;
+    double textAngle = (360 - angle1 - angle2/2) * M_PI / 180;
+    double tx = cr * cos(textAngle) + rect().center().x();
+    double ty = cr * sin(textAngle) + rect().center().y();
+
+    return QPoint(tx, ty);
+}
+
+
+}
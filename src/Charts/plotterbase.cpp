@@ -1,276 +1,1151 @@
-#include "plotterbase.h"
-#include "axisbase.h"
-
-
-namespace QSint
-{
-
-
-PlotterBase::PlotterBase(QWidget *parent) :
-    QWidget(parent),
-    m_model(0),
-    m_repaint(true),
-    m_antiAliasing(false)
-{
-    m_axisX = m_axisY = 0;
-
-    setBorderPen(QPen(Qt::gray));
-    setBackground(QBrush(Qt::lightGray));
-    setItemPen(QPen(Qt::darkGray));
-
-    setHighlightAlpha(0.5);
-    setHighlightTextColor(Qt::white);
-    setHighlightPen(QPen(Qt::black));
-    setHighlightBrush(QBrush(Qt::gray));
-
-    setModel(0);
-
-    setMouseTracking(true);
-}
-
-
-void PlotterBase::setBorderPen(const QPen &pen)
-{
-    m_pen = pen;
-}
-
-
-void PlotterBase::setBackground(const QBrush &brush)
-{
-    m_bg = brush;
-}
-
-
-void PlotterBase::setItemPen(const QPen &pen)
-{
-    m_itemPen = pen;
-}
-
-
-void PlotterBase::setFont(const QFont &font)
-{
-    m_font = font;
-}
-
-
-void PlotterBase::setHighlightTextColor(const QColor &color)
-{
-    m_hlTextColor = color;
-}
-
-
-void PlotterBase::setHighlightPen(const QPen &pen)
-{
-    m_hlPen = pen;
-}
-
-
-void PlotterBase::setHighlightBrush(const QBrush &brush)
-{
-    m_hlBrush = brush;
-}
-
-
-void PlotterBase::setHighlightAlpha(double alpha)
-{
-    m_hlAlpha = alpha;
-}
-
-
-void PlotterBase::setTextFormat(const QString &textFormat)
-{
-    m_textFormat = textFormat;
-
-    update();
-}
-
-
-QRect PlotterBase::dataRect() const
-{
-    QRect p_rect(rect());
-
-    if (m_axisX)
-        p_rect.setBottom(p_rect.bottom() - m_axisX->offset());
-
-    if (m_axisY)
-        p_rect.setLeft(p_rect.left() + m_axisY->offset());
-
-    return p_rect;
-}
-
-
-void PlotterBase::setModel(QAbstractItemModel *model)
-{
-    if (m_model)
-        m_model->disconnect(this);
-
-    m_model = model;
-
-    if (m_axisX)
-        m_axisX->setModel(model);
-
-    if (m_axisY)
-        m_axisY->setModel(model);
-
-    if (m_model)
-    {
-        connect(m_model, SIGNAL(dataChanged(const QModelIndex &,const QModelIndex &)),
-                this, SLOT(scheduleUpdate()));
-
-        connect(m_model, SIGNAL(headerDataChanged(Qt::Orientation, int, int)),
-                this, SLOT(scheduleUpdate()));
-
-        connect(m_model, SIGNAL(columnsInserted(const QModelIndex &, int, int)),
-                this, SLOT(scheduleUpdate()));
-
-        connect(m_model, SIGNAL(columnsRemoved(const QModelIndex &, int, int)),
-                this, SLOT(scheduleUpdate()));
-
-        connect(m_model, SIGNAL(rowsInserted(const QModelIndex &, int, int)),
-                this, SLOT(scheduleUpdate()));
-
-        connect(m_model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)),
-                this, SLOT(scheduleUpdate()));
-    }
-}
-
-
-void PlotterBase::scheduleUpdate()
-{
-    m_repaint = true;
-
-    update();
-}
-
-
-void PlotterBase::mousePressEvent(QMouseEvent *event)
-{
-    if (event->button() == Qt::LeftButton)
-    {
-        emit pressed(m_indexUnderMouse);
-
-        m_indexClick = m_indexUnderMouse;
-
-        //qDebug() << "pressed: " << m_indexUnderMouse;
-    }
-}
-
-
-void PlotterBase::mouseDoubleClickEvent(QMouseEvent *event)
-{
-    if (event->button() == Qt::LeftButton)
-    {
-        emit doubleClicked(m_indexUnderMouse);
-
-        //qDebug() << "doubleClicked: " << m_indexUnderMouse;
-    }
-}
-
-
-void PlotterBase::mouseReleaseEvent(QMouseEvent *event)
-{
-    if (m_indexClick == m_indexUnderMouse && event->button() == Qt::LeftButton)
-    {
-        emit clicked(m_indexUnderMouse);
-
-        m_indexClick = QModelIndex();
-
-        //qDebug() << "clicked: " << m_indexUnderMouse;
-    }
-}
-
-
-void PlotterBase::mouseMoveEvent(QMouseEvent *event)
-{
-    m_mousePos = event->pos();
-
-    update();
-}
-
-
-void PlotterBase::leaveEvent(QMouseEvent *event)
-{
-    m_mousePos = QPoint();
-    m_indexUnderMouse = m_indexClick = QModelIndex();
-
-    repaint();
-
-    QWidget::leaveEvent(event);
-}
-
-
-void PlotterBase::resizeEvent(QResizeEvent *event)
-{
-    m_mousePos = QPoint();
-    m_indexUnderMouse = m_indexClick = QModelIndex();
-
-    QWidget::resizeEvent(event);
-}
-
-
-void PlotterBase::paintEvent(QPaintEvent *)
-{
-    QPainter p(this);
-
-    if (m_antiAliasing)
-        p.setRenderHint(QPainter::Antialiasing);
-
-    drawBackground(p);
-
-    drawAxes(p);
-
-    drawContent(p);
-
-    drawForeground(p);
-}
-
-
-void PlotterBase::drawBackground(QPainter &p)
-{
-    p.fillRect(rect(), m_bg);
-}
-
-
-void PlotterBase::drawForeground(QPainter &p)
-{
-    p.setOpacity(1);
-    p.setPen(m_pen);
-    p.setBrush(Qt::NoBrush);
-    p.drawRect(rect().adjusted(0,0,-1,-1));
-}
-
-
-void PlotterBase::drawAxes(QPainter &p)
-{
-    if (m_axisX)
-        m_axisX->draw(p);
-
-    if (m_axisY)
-        m_axisY->draw(p);
-}
-
-
-QString PlotterBase::formattedValue(double value) const
-{
-    if (m_textFormat.isEmpty())
-    {
-        return QString::number(value);
-    }
-
-    return m_textFormat.arg(value);
-}
-
-
-void PlotterBase::setIndexUnderMouse(const QModelIndex& index)
-{
-    if (m_indexUnderMouse != index)
-    {
-        m_indexUnderMouse = index;
-
-        //if (index.isValid())
-            emit entered(index);
-    }
-}
-
-
-} // namespace
+#include <qmath.h>
+
+#include <QThread>
+#include <QFontDatabase>
+#include <QThreadStorage>
+
+#include "plotterbase.h"
+#include "axisbase.h"
+#include "chartstreammodel.h"
+
+
+namespace QSint
+{
+
+
+PlotterBase::PlotterBase(QWidget *parent) :
+    QWidget(parent),
+    m_model(0),
+    m_dirty(false),
+    m_restyle(true),
+    m_scrolled(0),
+    m_repaint(true),
+    m_relayout(true),
+    m_reload(true),
+    m_antiAliasing(false),
+    m_frameRate(0),
+    m_statsEnabled(false),
+    m_asyncRendering(false),
+    m_renderFrame(0),
+    m_shownFrame(0)
+{
+    m_axisX = m_axisY = 0;
+
+    // frames of the plotter are rendered one by one
+    m_renderPool.setMaxThreadCount(1);
+
+    // statistics of the frames are passed from the worker thread
+    qRegisterMetaType<QSint::PlotterBase::FrameStats>("QSint::PlotterBase::FrameStats");
+
+    setBorderPen(QPen(Qt::gray));
+    setBackground(QBrush(Qt::lightGray));
+    setItemPen(QPen(Qt::darkGray));
+
+    setHighlightAlpha(0.5);
+    setHighlightTextColor(Qt::white);
+    setHighlightPen(QPen(Qt::black));
+    setHighlightBrush(QBrush(Qt::gray));
+
+    setModel(0);
+
+    setMouseTracking(true);
+}
+
+
+PlotterBase::~PlotterBase()
+{
+    // the frames being rendered refer the plotter
+    m_renderPool.waitForDone();
+}
+
+
+void PlotterBase::setBorderPen(const QPen &pen)
+{
+    m_pen = pen;
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::setBackground(const QBrush &brush)
+{
+    m_bg = brush;
+
+    // the whole widget is covered by the cached content, unless the parent shows through it
+    setAttribute(Qt::WA_OpaquePaintEvent, m_bg.isOpaque());
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::setItemPen(const QPen &pen)
+{
+    m_itemPen = pen;
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::setFont(const QFont &font)
+{
+    m_font = font;
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::setHighlightTextColor(const QColor &color)
+{
+    m_hlTextColor = color;
+}
+
+
+void PlotterBase::setHighlightPen(const QPen &pen)
+{
+    m_hlPen = pen;
+}
+
+
+void PlotterBase::setHighlightBrush(const QBrush &brush)
+{
+    m_hlBrush = brush;
+}
+
+
+void PlotterBase::setHighlightAlpha(double alpha)
+{
+    m_hlAlpha = alpha;
+}
+
+
+void PlotterBase::setMaximumFrameRate(int fps)
+{
+    m_frameRate = qMax(0, fps);
+
+    // do not wait for the frame anymore
+    if (!m_frameRate && m_frameTimer.isActive())
+    {
+        m_frameTimer.stop();
+
+        update();
+    }
+}
+
+
+PlotterBase::FrameStats::FrameStats() :
+    layoutTime(0),
+    backgroundTime(0),
+    axesTime(0),
+    contentTime(0),
+    foregroundTime(0),
+    frameTime(0),
+    segmentsDrawn(0),
+    labelsDrawn(0),
+    labelsCulled(0)
+{
+}
+
+
+void PlotterBase::setFrameStatsEnabled(bool on)
+{
+    m_statsEnabled = on;
+
+    m_stats = m_lastStats = FrameStats();
+}
+
+
+void PlotterBase::setAsyncRendering(bool on)
+{
+    if (m_asyncRendering == on)
+        return;
+
+    m_asyncRendering = on;
+
+    m_renderSize = QSize();
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::setTextFormat(const QString &textFormat)
+{
+    m_formatter.setTextFormat(textFormat);
+
+    scheduleUpdate();
+}
+
+
+QRect PlotterBase::dataRect() const
+{
+    QRect p_rect(rect());
+
+    if (m_axisX)
+        p_rect.setBottom(p_rect.bottom() - m_axisX->offset());
+
+    if (m_axisY)
+        p_rect.setLeft(p_rect.left() + m_axisY->offset());
+
+    return p_rect;
+}
+
+
+void PlotterBase::setModel(QAbstractItemModel *model)
+{
+    if (m_model)
+        m_model->disconnect(this);
+
+    m_model = model;
+
+    if (m_axisX)
+        m_axisX->setModel(model);
+
+    if (m_axisY)
+        m_axisY->setModel(model);
+
+    if (m_model)
+    {
+        connect(m_model, SIGNAL(dataChanged(const QModelIndex &,const QModelIndex &)),
+                this, SLOT(onDataChanged(const QModelIndex &,const QModelIndex &)));
+
+        connect(m_model, SIGNAL(headerDataChanged(Qt::Orientation, int, int)),
+                this, SLOT(onHeaderDataChanged(Qt::Orientation, int, int)));
+
+        // stream model tells about its columns in one step
+        if (qobject_cast<ChartStreamModel*>(m_model))
+        {
+            connect(m_model, SIGNAL(columnsScrolled(int, int)),
+                    this, SLOT(onColumnsScrolled(int, int)));
+        }
+        else
+        {
+            connect(m_model, SIGNAL(columnsInserted(const QModelIndex &, int, int)),
+                    this, SLOT(invalidateData()));
+
+            connect(m_model, SIGNAL(columnsRemoved(const QModelIndex &, int, int)),
+                    this, SLOT(invalidateData()));
+        }
+
+        connect(m_model, SIGNAL(rowsInserted(const QModelIndex &, int, int)),
+                this, SLOT(invalidateData()));
+
+        connect(m_model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)),
+                this, SLOT(invalidateData()));
+
+        connect(m_model, SIGNAL(modelReset()),
+                this, SLOT(invalidateData()));
+
+        connect(m_model, SIGNAL(layoutChanged()),
+                this, SLOT(invalidateData()));
+    }
+
+    invalidateData();
+}
+
+
+void PlotterBase::scheduleUpdate()
+{
+    m_repaint = true;
+    m_relayout = true;
+
+    requestUpdate();
+}
+
+
+void PlotterBase::invalidateData()
+{
+    m_reload = true;
+    m_dirty = false;
+    m_restyle = true;
+
+    invalidateAxes();
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    // the snapshot is to be re-read completely
+    if (m_reload)
+        return;
+
+    if (!m_model || !topLeft.isValid() || !bottomRight.isValid() ||
+        m_model->rowCount() != m_data.rowCount() ||
+        m_model->columnCount() != m_data.columnCount())
+    {
+        invalidateData();
+        return;
+    }
+
+    // the snapshot is updated once before the next painting
+    if (!m_dirty)
+    {
+        m_dirtyColumns.fill(false, m_data.columnCount());
+        m_dirtyTop = topLeft.row();
+        m_dirtyBottom = bottomRight.row();
+        m_dirty = true;
+    }
+    else
+    {
+        m_dirtyTop = qMin(m_dirtyTop, topLeft.row());
+        m_dirtyBottom = qMax(m_dirtyBottom, bottomRight.row());
+    }
+
+    for (int c = topLeft.column(); c <= bottomRight.column(); c++)
+        m_dirtyColumns.setBit(c);
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::onHeaderDataChanged(Qt::Orientation orientation, int /*first*/, int /*last*/)
+{
+    if (orientation == Qt::Vertical)
+        m_restyle = true;
+    else
+        invalidateAxes();
+
+    scheduleUpdate();
+}
+
+
+void PlotterBase::onColumnsScrolled(int removed, int added)
+{
+    // the snapshot is to be re-read completely
+    if (m_reload)
+        return;
+
+    // changed columns have been moved as well
+    if (m_dirty)
+    {
+        QBitArray columns(qMax(0, m_dirtyColumns.size() - removed));
+        for (int c = 0; c < columns.size(); c++)
+            columns.setBit(c, m_dirtyColumns.testBit(c + removed));
+
+        m_dirtyColumns = columns;
+        m_dirtyColumns.resize(columns.size() + added);
+    }
+
+    m_data.scroll(m_model, removed, added);
+
+    // header labels have been moved as well
+    invalidateAxes();
+
+    // items have been moved away from the mouse cursor
+    setIndexUnderMouse(QModelIndex());
+    m_indexClick = QModelIndex();
+
+    // the number of the columns is the same, so the content could be just scrolled
+    if (removed == added && !m_repaint)
+    {
+        m_scrolled += added;
+        m_relayout = true;
+
+        requestUpdate();
+    }
+    else
+        scheduleUpdate();
+}
+
+
+void PlotterBase::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        emit pressed(m_indexUnderMouse);
+
+        m_indexClick = m_indexUnderMouse;
+
+        //qDebug() << "pressed: " << m_indexUnderMouse;
+    }
+}
+
+
+void PlotterBase::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        emit doubleClicked(m_indexUnderMouse);
+
+        //qDebug() << "doubleClicked: " << m_indexUnderMouse;
+    }
+}
+
+
+void PlotterBase::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (m_indexClick == m_indexUnderMouse && event->button() == Qt::LeftButton)
+    {
+        emit clicked(m_indexUnderMouse);
+
+        m_indexClick = QModelIndex();
+
+        //qDebug() << "clicked: " << m_indexUnderMouse;
+    }
+}
+
+
+void PlotterBase::mouseMoveEvent(QMouseEvent *event)
+{
+    m_mousePos = event->pos();
+
+    // hit-tested against the layout the shown content has been rendered from,
+    // the data changed meanwhile is laid out by the next frame
+    QModelIndex index(indexAt(m_mousePos));
+    if (index != m_indexUnderMouse)
+    {
+        // repaint the old and the new highlighted items only
+        QRect dirtyRect(highlightRect(m_indexUnderMouse) | highlightRect(index));
+
+        setIndexUnderMouse(index);
+
+        if (!dirtyRect.isEmpty())
+            update(dirtyRect);
+    }
+}
+
+
+void PlotterBase::leaveEvent(QEvent *event)
+{
+    QRect dirtyRect(highlightRect(m_indexUnderMouse));
+
+    m_mousePos = QPoint();
+    m_indexUnderMouse = m_indexClick = QModelIndex();
+
+    if (!dirtyRect.isEmpty())
+        update(dirtyRect);
+
+    QWidget::leaveEvent(event);
+}
+
+
+void PlotterBase::resizeEvent(QResizeEvent *event)
+{
+    m_mousePos = QPoint();
+    m_indexUnderMouse = m_indexClick = QModelIndex();
+
+    m_relayout = true;
+
+    QWidget::resizeEvent(event);
+}
+
+
+/// Renders a snapshot of the plotter into an image in the worker thread.
+class PlotterBase::RenderTask : public QRunnable
+{
+public:
+    RenderTask(PlotterBase *plotter, PlotterBase *snapshot, const QSize &size, qreal dpr, int frame) :
+        m_plotter(plotter),
+        m_snapshot(snapshot),
+        m_size(size),
+        m_dpr(dpr),
+        m_frame(frame)
+    {
+    }
+
+    virtual void run()
+    {
+        QImage image;
+
+#if QT_VERSION >= 0x050000
+        int lastFrame = m_plotter->m_renderFrame.loadAcquire();
+#else
+        int lastFrame = m_plotter->m_renderFrame;
+#endif
+
+        // the frame would be stale since a newer one has been requested already
+        if (m_frame == lastFrame)
+        {
+            image = QImage(m_size, QImage::Format_ARGB32_Premultiplied);
+#if QT_VERSION >= 0x050600
+            image.setDevicePixelRatio(m_dpr);
+#endif
+
+            // the background could be translucent
+            image.fill(Qt::transparent);
+
+            QPainter p(&image);
+            m_snapshot->renderLayers(p);
+        }
+
+        FrameStats stats = m_snapshot->m_stats;
+
+        // the snapshot belongs to GUI thread
+        m_snapshot->deleteLater();
+
+        QMetaObject::invokeMethod(m_plotter, "onFrameRendered", Qt::QueuedConnection,
+                                  Q_ARG(QImage, image), Q_ARG(int, m_frame),
+                                  Q_ARG(QSint::PlotterBase::FrameStats, stats));
+    }
+
+private:
+    PlotterBase *m_plotter;
+    PlotterBase *m_snapshot;
+    QSize m_size;
+    qreal m_dpr;
+    int m_frame;
+};
+
+
+/// Renders a horizontal band of the image in the worker thread.
+class PlotterBase::BandTask : public QRunnable
+{
+public:
+    BandTask(PlotterBase *snapshot, uchar *bits, int bytesPerLine, QImage::Format format, const QRect &band) :
+        m_snapshot(snapshot),
+        m_bits(bits),
+        m_bytesPerLine(bytesPerLine),
+        m_format(format),
+        m_band(band)
+    {
+    }
+
+    virtual void run()
+    {
+        // the band shares pixels with the whole image, but has its own paint engine
+        QImage image(m_bits, m_band.width(), m_band.height(), m_bytesPerLine, m_format);
+
+        QPainter p(&image);
+        p.translate(0, -m_band.top());
+
+        m_snapshot->renderLayers(p, m_band);
+    }
+
+private:
+    PlotterBase *m_snapshot;
+    uchar *m_bits;
+    int m_bytesPerLine;
+    QImage::Format m_format;
+    QRect m_band;
+};
+
+
+void PlotterBase::paintEvent(QPaintEvent *)
+{
+#if QT_VERSION >= 0x050600
+    const qreal dpr = devicePixelRatioF();
+#else
+    const qreal dpr = 1;
+#endif
+
+    QSize bufferSize(size() * dpr);
+
+    QElapsedTimer frameTimer;
+    if (m_statsEnabled)
+        frameTimer.start();
+
+    // changes are collected until the next frame
+    bool frame = !m_frameTimer.isActive();
+
+    // the next frame is rendered in the worker thread, the last finished one is shown meanwhile
+    if (m_asyncRendering && (((m_repaint || m_scrolled) && frame) || m_renderSize != bufferSize))
+    {
+        ensureLayout();
+
+        if (startRender(bufferSize, dpr))
+        {
+            m_repaint = false;
+            m_scrolled = 0;
+
+            m_frameClock.start();
+        }
+    }
+
+    bool async = m_renderSize.isValid();
+
+    // static layers are rendered only after invalidation or resize
+    if (!async && ((m_repaint && frame) || m_buffer.size() != bufferSize))
+    {
+        ensureLayout();
+
+        m_buffer = QPixmap(bufferSize);
+#if QT_VERSION >= 0x050600
+        m_buffer.setDevicePixelRatio(dpr);
+#endif
+
+        renderBuffer();
+
+        m_repaint = false;
+        m_scrolled = 0;
+
+        m_frameClock.start();
+    }
+    else if (!async && m_scrolled && frame)
+    {
+        ensureLayout();
+
+        int dx = scrollDistance(m_scrolled);
+
+        // scrolling by fractional device pixels would blur the content,
+        // and the layout could have changed the scale of the content (see BarChartPlotter::setAutoRange())
+        if (dx && dpr == int(dpr) && !m_repaint)
+            scrollBuffer(dx);
+        else
+            renderBuffer();
+
+        m_repaint = false;
+        m_scrolled = 0;
+
+        m_frameClock.start();
+    }
+
+    QPainter p(this);
+
+    // the frame of the new size is not rendered yet
+    if (m_buffer.size() != bufferSize)
+        p.fillRect(rect(), m_bg);
+
+    p.drawPixmap(0, 0, m_buffer);
+
+    if (m_antiAliasing)
+        p.setRenderHint(QPainter::Antialiasing);
+
+    if (!m_statsEnabled)
+    {
+        drawHighlight(p);
+        drawForeground(p);
+        return;
+    }
+
+    qint64 t = frameTimer.nsecsElapsed();
+
+    drawHighlight(p);
+    drawForeground(p);
+
+    m_stats.frameTime = frameTimer.nsecsElapsed();
+    m_stats.foregroundTime = m_stats.frameTime - t;
+
+    m_lastStats = m_stats;
+    m_stats = FrameStats();
+
+    Q_EMIT framePainted(m_lastStats);
+}
+
+
+void PlotterBase::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_frameTimer.timerId())
+    {
+        m_frameTimer.stop();
+
+        update();
+        return;
+    }
+
+    QWidget::timerEvent(event);
+}
+
+
+void PlotterBase::requestUpdate()
+{
+    if (m_frameRate <= 0)
+    {
+        update();
+        return;
+    }
+
+    // the frame has been scheduled already
+    if (m_frameTimer.isActive())
+        return;
+
+    int interval = 1000 / m_frameRate;
+    qint64 elapsed = m_frameClock.isValid() ? m_frameClock.elapsed() : interval;
+
+    if (elapsed >= interval)
+        update();
+    else
+        m_frameTimer.start(interval - elapsed, this);
+}
+
+
+void PlotterBase::renderBuffer(const QRect &clip)
+{
+    QPainter bp(&m_buffer);
+
+    // translucent background is painted over the transparent pixels, not over the old content
+    if (!m_bg.isOpaque())
+    {
+        bp.setCompositionMode(QPainter::CompositionMode_Source);
+        bp.fillRect(clip.isValid() ? clip : m_buffer.rect(), Qt::transparent);
+        bp.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    }
+
+    renderLayers(bp, clip);
+}
+
+
+void PlotterBase::renderLayers(QPainter &bp, const QRect &clip)
+{
+    bp.setPen(palette().color(foregroundRole()));
+    bp.setFont(QWidget::font());
+
+    if (clip.isValid())
+        bp.setClipRect(clip);
+
+    if (m_antiAliasing)
+        bp.setRenderHint(QPainter::Antialiasing);
+
+    if (!m_statsEnabled)
+    {
+        drawBackground(bp);
+        drawAxes(bp);
+        drawContent(bp);
+        return;
+    }
+
+    // the layers could be rendered several times per frame (see scrollBuffer())
+    QElapsedTimer timer;
+    timer.start();
+
+    drawBackground(bp);
+
+    qint64 t1 = timer.nsecsElapsed();
+    drawAxes(bp);
+
+    qint64 t2 = timer.nsecsElapsed();
+    drawContent(bp);
+
+    qint64 t3 = timer.nsecsElapsed();
+
+    m_stats.backgroundTime += t1;
+    m_stats.axesTime += t2 - t1;
+    m_stats.contentTime += t3 - t2;
+}
+
+
+void PlotterBase::scrollBuffer(int dx)
+{
+    // the Y axis is painted over the left side of the data rectangle
+    QRect area(dataRect().adjusted(5, 0, 0, 0));
+
+    if (qAbs(dx) >= area.width())
+    {
+        renderBuffer();
+        return;
+    }
+
+#if QT_VERSION >= 0x050600
+    const int dpr = m_buffer.devicePixelRatio();
+#else
+    const int dpr = 1;
+#endif
+
+    m_buffer.scroll(dx * dpr, 0, QRect(area.topLeft() * dpr, area.size() * dpr));
+
+    QVector<QRect> exposed;
+
+    // everything around the scrolled area
+    exposed << QRect(0, 0, width(), area.top());
+    exposed << QRect(0, area.bottom() + 1, width(), height() - area.bottom() - 1);
+    exposed << QRect(0, area.top(), area.left(), area.height());
+    exposed << QRect(area.right() + 1, area.top(), width() - area.right() - 1, area.height());
+
+    // exposed part of the area; value texts of the new items could reach into the scrolled part
+    int margin = textMargin();
+
+    if (dx < 0)
+        exposed << (QRect(area.right() + dx + 1 - margin, area.top(), margin - dx, area.height()) & area);
+    else
+        exposed << (QRect(area.left(), area.top(), dx + margin, area.height()) & area);
+
+    for (int i = 0; i < exposed.count(); i++)
+    {
+        if (!exposed.at(i).isEmpty())
+            renderBuffer(exposed.at(i));
+    }
+}
+
+
+PlotterBase* PlotterBase::clone() const
+{
+    return 0;
+}
+
+
+void PlotterBase::copyState(const PlotterBase &other)
+{
+    resize(other.size());
+    setPalette(other.palette());
+    QWidget::setFont(other.QWidget::font());
+
+    // the model is not accessed by the copy, the pointer is only checked
+    m_model = other.m_model;
+    m_data = other.m_data;
+    m_styles = other.m_styles;
+
+    m_bg = other.m_bg;
+    m_pen = other.m_pen;
+    m_itemPen = other.m_itemPen;
+    m_font = other.m_font;
+    m_formatter = other.m_formatter;
+    m_antiAliasing = other.m_antiAliasing;
+    m_statsEnabled = other.m_statsEnabled;
+
+    if (m_axisX && other.m_axisX)
+        m_axisX->copyState(*other.m_axisX);
+
+    if (m_axisY && other.m_axisY)
+        m_axisY->copyState(*other.m_axisY);
+
+    // the layout is copied by clone()
+    m_reload = m_restyle = m_relayout = m_dirty = false;
+}
+
+
+bool PlotterBase::startRender(const QSize &size, qreal dpr)
+{
+#if QT_VERSION >= 0x040800
+    // the texts could be painted in GUI thread only, the frame is painted synchronously
+    if (!QFontDatabase::supportsThreadedFontRendering())
+    {
+        m_renderSize = QSize();
+        return false;
+    }
+#endif
+
+    PlotterBase *snapshot = clone();
+    if (!snapshot)
+    {
+        m_renderSize = QSize();
+        return false;
+    }
+
+    m_renderSize = size;
+
+    int frame = m_renderFrame.fetchAndAddOrdered(1) + 1;
+
+    m_renderPool.start(new RenderTask(this, snapshot, size, dpr, frame));
+
+    return true;
+}
+
+
+QImage PlotterBase::renderImage(const QSize &size, int bands)
+{
+    ensureLayout();
+
+    PlotterBase *snapshot = clone();
+    if (!snapshot)
+        return QImage();
+
+    // layout of the copy is recalculated for the image size
+    snapshot->resize(size);
+    snapshot->m_relayout = true;
+    snapshot->ensureLayout();
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+
+    // the background could be translucent
+    image.fill(Qt::transparent);
+
+    if (bands <= 0)
+        bands = QThread::idealThreadCount();
+
+#if QT_VERSION >= 0x040800
+    if (!QFontDatabase::supportsThreadedFontRendering())
+        bands = 1;
+#endif
+
+    bands = qMin(bands, image.height());
+
+    // the bands would count into the same statistics, and nobody reads them
+    snapshot->m_statsEnabled = false;
+
+    if (bands <= 1)
+    {
+        if (!image.isNull())
+        {
+            QPainter p(&image);
+            snapshot->renderLayers(p);
+        }
+    }
+    else
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(bands);
+
+        for (int i = 0; i < bands; i++)
+        {
+            int top = image.height() * i / bands;
+            int bottom = image.height() * (i + 1) / bands;
+
+            QRect band(0, top, image.width(), bottom - top);
+
+            pool.start(new BandTask(snapshot, image.scanLine(top), image.bytesPerLine(), image.format(), band));
+        }
+
+        pool.waitForDone();
+    }
+
+    // the border as painted by the widget
+    if (!image.isNull())
+    {
+        QPainter p(&image);
+        snapshot->drawForeground(p);
+    }
+
+    delete snapshot;
+
+    return image;
+}
+
+
+void PlotterBase::onFrameRendered(const QImage &image, int frame, const QSint::PlotterBase::FrameStats &stats)
+{
+    // the frame has been dropped in favour of a newer one
+    if (image.isNull() || frame <= m_shownFrame)
+        return;
+
+    // the plotter has been resized meanwhile, another frame is coming
+    if (image.size() != m_renderSize)
+        return;
+
+    m_buffer = QPixmap::fromImage(image);
+    m_shownFrame = frame;
+
+    // reported by the frame showing the image
+    if (m_statsEnabled)
+    {
+        m_stats.backgroundTime += stats.backgroundTime;
+        m_stats.axesTime += stats.axesTime;
+        m_stats.contentTime += stats.contentTime;
+        m_stats.segmentsDrawn += stats.segmentsDrawn;
+        m_stats.labelsDrawn += stats.labelsDrawn;
+        m_stats.labelsCulled += stats.labelsCulled;
+    }
+
+    update();
+}
+
+
+int PlotterBase::scrollDistance(int /*columns*/) const
+{
+    return 0;
+}
+
+
+int PlotterBase::textMargin() const
+{
+    return QFontMetrics(m_font).width(QLatin1String("00000000"));
+}
+
+
+void PlotterBase::drawBackground(QPainter &p)
+{
+    p.fillRect(rect(), m_bg);
+}
+
+
+void PlotterBase::drawForeground(QPainter &p)
+{
+    p.setOpacity(1);
+    p.setPen(m_pen);
+    p.setBrush(Qt::NoBrush);
+    p.drawRect(rect().adjusted(0,0,-1,-1));
+}
+
+
+void PlotterBase::drawHighlight(QPainter &/*p*/)
+{
+}
+
+
+QRect PlotterBase::highlightRect(const QModelIndex &index) const
+{
+    return index.isValid() ? rect() : QRect();
+}
+
+
+QRect PlotterBase::pieSegmentRect(const QRect &pieRect, double angle1, double angle2)
+{
+    if (qAbs(angle2) >= 360)
+        return pieRect;
+
+    double rx = pieRect.width() / 2.0;
+    double ry = pieRect.height() / 2.0;
+    double cx = pieRect.left() + rx;
+    double cy = pieRect.top() + ry;
+
+    double start = qMin(angle1, angle1 + angle2);
+    double end = qMax(angle1, angle1 + angle2);
+
+    // the center, the ends of the arc and its extremes on the axes
+    double left = cx, right = cx, top = cy, bottom = cy;
+
+    QVector<double> angles;
+    angles << start << end;
+    for (double a = qCeil(start / 90) * 90; a < end; a += 90)
+        angles << a;
+
+    for (int i = 0; i < angles.count(); i++)
+    {
+        double a = angles.at(i) * M_PI / 180;
+
+        // y axis is directed down
+        double x = cx + rx * cos(a);
+        double y = cy - ry * sin(a);
+
+        left = qMin(left, x);
+        right = qMax(right, x);
+        top = qMin(top, y);
+        bottom = qMax(bottom, y);
+    }
+
+    return QRect(QPoint(qFloor(left), qFloor(top)), QPoint(qCeil(right), qCeil(bottom)));
+}
+
+
+void PlotterBase::drawAxes(QPainter &p)
+{
+    if (m_axisX)
+        m_axisX->draw(p);
+
+    if (m_axisY)
+        m_axisY->draw(p);
+}
+
+
+void PlotterBase::calculateLayout()
+{
+}
+
+
+void PlotterBase::ensureLayout()
+{
+    if (m_relayout)
+    {
+        QElapsedTimer timer;
+        if (m_statsEnabled)
+            timer.start();
+
+        if (m_reload)
+        {
+            m_data.read(m_model);
+
+            m_reload = false;
+            m_dirty = false;
+        }
+        else if (m_dirty)
+        {
+            updateData();
+        }
+
+        if (m_restyle || m_styles.count() != m_data.rowCount())
+        {
+            updateStyles();
+        }
+
+        calculateLayout();
+
+        if (m_axisX)
+            m_axisX->calculateLabels();
+
+        if (m_axisY)
+            m_axisY->calculateLabels();
+
+        m_relayout = false;
+
+        if (m_statsEnabled)
+            m_stats.layoutTime += timer.nsecsElapsed();
+    }
+}
+
+
+void PlotterBase::invalidateAxes()
+{
+    if (m_axisX)
+        m_axisX->invalidate();
+
+    if (m_axisY)
+        m_axisY->invalidate();
+}
+
+
+void PlotterBase::updateData()
+{
+    // re-read the sequences of the changed columns
+    int count = m_dirtyColumns.size();
+
+    for (int c = 0; c < count; c++)
+    {
+        if (!m_dirtyColumns.testBit(c))
+            continue;
+
+        int last = c;
+        while (last + 1 < count && m_dirtyColumns.testBit(last + 1))
+            last++;
+
+        m_data.update(m_model, m_dirtyTop, c, m_dirtyBottom, last);
+
+        c = last;
+    }
+
+    m_dirty = false;
+}
+
+
+void PlotterBase::updateStyles()
+{
+    int count = m_data.rowCount();
+
+    m_styles.resize(count);
+
+    for (int r = 0; r < count; r++)
+    {
+        SeriesStyle &style = m_styles[r];
+
+        style.brush = qvariant_cast<QBrush>(m_model->headerData(r, Qt::Vertical, Qt::BackgroundRole));
+        style.textPen = QPen(qvariant_cast<QColor>(m_model->headerData(r, Qt::Vertical, Qt::ForegroundRole)));
+    }
+
+    m_restyle = false;
+}
+
+
+QModelIndex PlotterBase::indexAt(const QPoint &/*pos*/) const
+{
+    return QModelIndex();
+}
+
+
+QString PlotterBase::formattedValue(double value) const
+{
+    QString text;
+    formatValue(value, text);
+
+    return text;
+}
+
+
+void PlotterBase::formatValue(double value, QString &text) const
+{
+    m_formatter.format(value, text);
+}
+
+
+/// text buffers of the threads painting the plotters (see textBuffer())
+static QThreadStorage<QString*> textBuffers;
+
+
+QString& PlotterBase::textBuffer()
+{
+    if (!textBuffers.hasLocalData())
+        textBuffers.setLocalData(new QString());
+
+    return *textBuffers.localData();
+}
+
+
+void PlotterBase::setIndexUnderMouse(const QModelIndex& index)
+{
+    if (m_indexUnderMouse != index)
+    {
+        m_indexUnderMouse = index;
+
+        //if (index.isValid())
+            emit entered(index);
+    }
+}
+
+
+} // namespace
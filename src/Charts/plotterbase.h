@@ -1,183 +1,432 @@
-#ifndef PLOTTERBASE_H
-#define PLOTTERBASE_H
-
-
-#include <QPen>
-#include <QBrush>
-#include <QPainter>
-#include <QMouseEvent>
-#include <QWidget>
-
-#include <QtCore/QAbstractItemModel>
-
-
-namespace QSint
-{
-
-
-class AxisBase;
-
-
-/**
-    \brief Base class for 2-dimensional plotter widgets.
-    \since 0.2.1
-
-    Class provides basic grid and background painting and user interaction handling.
-
-    It has easy-to-use API and performs fast "native" painting (directly via QPainter).
-
-    Class is intended to be a basic for the charting widgets supporting MVC ideology
-    and using QAbstractItemModel as data source. The model is to be set via setModel() method.
-
-    By default it is assumed that the model has 2-dimensional tabular structure.
-    Each model row represents corresponding value on the X axis, with the column data values placed on Y axis.
-    Axes could be accessed via axisX() and axisY() methods.
-*/
-class PlotterBase : public QWidget
-{
-    Q_OBJECT
-public:
-    explicit PlotterBase(QWidget *parent = 0);
-
-
-    /// Sets pen of the plotter's border to \a pen.
-    void setBorderPen(const QPen &pen);
-    /// Retrieves plotter's border pen.
-    inline const QPen& borderPen() const { return m_pen; }
-
-    /// Sets plotter's background to \a brush.
-    void setBackground(const QBrush &brush);
-    /// Retrieves plotter background.
-    inline const QBrush& background() const { return m_bg; }
-
-    /// Sets font of the data item to \a font.
-    void setFont(const QFont &font);
-    /// Retrieves data item font.
-    inline const QFont& font() const { return m_font; }
-
-    /// Sets pen of the data item to \a pen.
-    void setItemPen(const QPen &pen);
-    inline const QPen& itemPen() const { return m_itemPen; }
-
-    /// Sets color of the highlighted data item text to \a color.
-    void setHighlightTextColor(const QColor &color);
-    /// Retrieves highlighted data item text color.
-    inline const QColor& highlightTextColor() const { return m_hlTextColor; }
-
-    /// Sets pen of the highlighted data item to \a pen.
-    void setHighlightPen(const QPen &pen);
-    /// Retrieves highlighted data item pen.
-    inline const QPen& highlightPen() const { return m_hlPen; }
-
-    /// Sets brush of the highlighted data item to \a brush.
-    void setHighlightBrush(const QBrush &brush);
-    /// Retrieves highlighted data item brush.
-    inline const QBrush& highlightBrush() const { return m_hlBrush; }
-
-    /// Sets opacity of the highlighted data item to \a alpha.
-    /// Value should be in ranges between 0.1 and 1.0, 1.0 is the default.
-    void setHighlightAlpha(double alpha);
-    /// Retrieves highlighted data item opacity.
-    inline double highlightAlpha() const { return m_hlAlpha; }
-
-
-    void setTextFormat(const QString& textFormat);
-    QString textFormat() const { return m_textFormat; }
-
-
-    /// Enables (\a set=true, the default) or disables (\a set=false) painter's antialiasing.
-    inline void setAntiAliasing(bool set) { m_antiAliasing = set;}
-
-
-    /// Retrieves X axis object.
-    inline AxisBase* axisX() const { return m_axisX; }
-    /// Retrieves Y axis object.
-    inline AxisBase* axisY() const { return m_axisY; }
-
-
-    /// Sets data model to \a model.
-    void setModel(QAbstractItemModel *model);
-    /// Retrieves active data model or NULL if not set.
-    inline QAbstractItemModel* model() const { return m_model; }
-
-
-    /// Retrieves data rectangle (excluding margins and axes).
-    QRect dataRect() const;
-
-    /// Retrieves current mouse cursor position in local coordinates.
-    const QPoint& mousePos() const { return m_mousePos; }
-    /// Retrieves current mouse cursor position in global coordinates.
-    QPoint globalMousePos() const { return mapToGlobal(m_mousePos); }
-
-    /// Retrieves highlighted data model index, or invalid QModelIndex if nothing highlighted.
-    const QModelIndex& highlightedIndex() const { return m_indexUnderMouse; }
-
-Q_SIGNALS:
-    /// Emitted when the data item at \a index has been entered by the mouse cursor.
-    /// If \a index is invalid that means entering the space without data.
-    void entered(const QModelIndex& index);
-    /// Emitted when the mouse button has been pressed over the data item at \a index.
-    void pressed(const QModelIndex& index);
-    /// Emitted when the mouse button has been clicked over the data item at \a index.
-    void clicked(const QModelIndex& index);
-    /// Emitted when the mouse button has been double clicked over the data item at \a index.
-    void doubleClicked(const QModelIndex& index);
-
-protected Q_SLOTS:
-    void scheduleUpdate();
-
-protected:
-    virtual void mousePressEvent(QMouseEvent *event);
-    virtual void mouseDoubleClickEvent(QMouseEvent *event);
-    virtual void mouseReleaseEvent(QMouseEvent *event);
-
-    virtual void mouseMoveEvent(QMouseEvent *event);
-    virtual void leaveEvent(QMouseEvent *event);
-
-    virtual void paintEvent(QPaintEvent *event);
-    virtual void resizeEvent(QResizeEvent *event);
-
-    /// Draws default background of the plotter.
-    virtual void drawBackground(QPainter &p);
-    /// Draws default foreground of the plotter.
-    virtual void drawForeground(QPainter &p);
-    /// Draws axes of the plotter.
-    virtual void drawAxes(QPainter &p);
-    /// Draws content of the plotter.
-    virtual void drawContent(QPainter &p) = 0;
-
-    virtual QString formattedValue(double value) const;
-
-    void setIndexUnderMouse(const QModelIndex& index);
-
-    AxisBase *m_axisX;
-    AxisBase *m_axisY;
-
-    QAbstractItemModel *m_model;
-
-    QBrush m_bg;
-    QPen m_pen;
-
-    QPen m_itemPen;
-    QFont m_font;
-
-    QColor m_hlTextColor;
-    QPen m_hlPen;
-    QBrush m_hlBrush;
-    double m_hlAlpha;
-
-    QString m_textFormat;
-
-    QPixmap m_buffer;
-    bool m_repaint;
-    bool m_antiAliasing;
-
-    QPoint m_mousePos;
-    QModelIndex m_indexUnderMouse;
-    QModelIndex m_indexClick;
-};
-
-
-} // namespace
-
-#endif // PLOTTERBASE_H
+#ifndef PLOTTERBASE_H
+#define PLOTTERBASE_H
+
+
+#include <QPen>
+#include <QBrush>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QWidget>
+#include <QBitArray>
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+#include <QtCore/QAbstractItemModel>
+
+#include "chartdata.h"
+#include "valueformatter.h"
+
+
+namespace QSint
+{
+
+
+class AxisBase;
+class ChartRenderer;
+
+
+/**
+    \brief Base class for 2-dimensional plotter widgets.
+    \since 0.2.1
+
+    Class provides basic grid and background painting and user interaction handling.
+
+    It has easy-to-use API and performs fast "native" painting (directly via QPainter).
+
+    Class is intended to be a basic for the charting widgets supporting MVC ideology
+    and using QAbstractItemModel as data source. The model is to be set via setModel() method.
+
+    By default it is assumed that the model has 2-dimensional tabular structure.
+    Each model row represents corresponding value on the X axis, with the column data values placed on Y axis.
+    Axes could be accessed via axisX() and axisY() methods.
+
+    For the real-time data ChartStreamModel could be used: when its columns are scrolled,
+    the cached content of the plotter is scrolled as well and only the new columns are painted
+    (if the plotter supports it, see scrollDistance()).
+
+    Large charts could be rendered in a worker thread (see setAsyncRendering()).
+*/
+class PlotterBase : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PlotterBase(QWidget *parent = 0);
+    virtual ~PlotterBase();
+
+
+    /// Sets pen of the plotter's border to \a pen.
+    void setBorderPen(const QPen &pen);
+    /// Retrieves plotter's border pen.
+    inline const QPen& borderPen() const { return m_pen; }
+
+    /// Sets plotter's background to \a brush.
+    void setBackground(const QBrush &brush);
+    /// Retrieves plotter background.
+    inline const QBrush& background() const { return m_bg; }
+
+    /// Sets font of the data item to \a font.
+    void setFont(const QFont &font);
+    /// Retrieves data item font.
+    inline const QFont& font() const { return m_font; }
+
+    /// Sets pen of the data item to \a pen.
+    void setItemPen(const QPen &pen);
+    inline const QPen& itemPen() const { return m_itemPen; }
+
+    /// Sets color of the highlighted data item text to \a color.
+    void setHighlightTextColor(const QColor &color);
+    /// Retrieves highlighted data item text color.
+    inline const QColor& highlightTextColor() const { return m_hlTextColor; }
+
+    /// Sets pen of the highlighted data item to \a pen.
+    void setHighlightPen(const QPen &pen);
+    /// Retrieves highlighted data item pen.
+    inline const QPen& highlightPen() const { return m_hlPen; }
+
+    /// Sets brush of the highlighted data item to \a brush.
+    void setHighlightBrush(const QBrush &brush);
+    /// Retrieves highlighted data item brush.
+    inline const QBrush& highlightBrush() const { return m_hlBrush; }
+
+    /// Sets opacity of the highlighted data item to \a alpha.
+    /// Value should be in ranges between 0.1 and 1.0, 1.0 is the default.
+    void setHighlightAlpha(double alpha);
+    /// Retrieves highlighted data item opacity.
+    inline double highlightAlpha() const { return m_hlAlpha; }
+
+
+    void setTextFormat(const QString& textFormat);
+    QString textFormat() const { return m_formatter.textFormat(); }
+
+
+    /// Enables (\a set=true, the default) or disables (\a set=false) painter's antialiasing.
+    inline void setAntiAliasing(bool set) { m_antiAliasing = set; scheduleUpdate(); }
+
+    /** Limits repainting of the plotter after the data or appearance changes to \a fps frames per second.
+        The changes made between the frames are collected and processed at once before the next frame.
+        0 (the default) means no limit.
+        \since 0.2.3
+    */
+    void setMaximumFrameRate(int fps);
+    /// Retrieves maximal number of the frames per second. \sa setMaximumFrameRate()
+    inline int maximumFrameRate() const { return m_frameRate; }
+
+    /** Enables (\a on=true) or disables (\a on=false, the default) rendering of the plotter
+        in a worker thread. When enabled, a copy of the plotter (see clone()) renders the content
+        into an image and the last finished frame is shown meanwhile, so the event loop is not
+        blocked by painting of large data. Frames outdated by the newer ones are dropped.
+        Has no effect if the plotter does not support cloning, or if the platform does not support
+        rendering of the texts outside of GUI thread (see QFontDatabase::supportsThreadedFontRendering()).
+        \since 0.2.3
+    */
+    void setAsyncRendering(bool on);
+    /// Returns true if the plotter is rendered in a worker thread. \sa setAsyncRendering()
+    inline bool asyncRendering() const { return m_asyncRendering; }
+
+    /** Renders the plotter into an image of \a size (i.e. for export at the sizes much larger
+        than the widget). The image is split into \a bands horizontal bands rendered in parallel
+        (0 means one band per CPU core); the result is the same as rendered by a single thread.
+        The image includes the foreground (the border), but not the highlighted item.
+        Returns null image if the plotter does not support cloning (see clone()).
+        \since 0.2.3
+    */
+    QImage renderImage(const QSize &size, int bands = 0);
+
+
+    /// \brief Statistics of a painted frame (see setFrameStatsEnabled()).
+    /// \since 0.2.3
+    struct FrameStats
+    {
+        FrameStats();
+
+        /// time (in nanoseconds) of updating the data snapshot and the layout of the items
+        qint64 layoutTime;
+        /// time of painting the background (0 if the cached content has been shown)
+        qint64 backgroundTime;
+        /// time of painting the axes (0 if the cached content has been shown)
+        qint64 axesTime;
+        /// time of painting the data items (0 if the cached content has been shown)
+        qint64 contentTime;
+        /// time of painting the highlighted item and the foreground
+        qint64 foregroundTime;
+        /// total time of the frame, including the layout and showing the cached content
+        qint64 frameTime;
+
+        /// number of the data items (bars, segments, trend lines and points) drawn
+        int segmentsDrawn;
+        /// number of the value texts and axis labels drawn
+        int labelsDrawn;
+        /// number of the value texts and axis labels skipped since they would overlap
+        int labelsCulled;
+    };
+
+    /** Enables (\a on=true) or disables (\a on=false, the default) collecting of the statistics
+        of the painted frames. When enabled, framePainted() is emitted after every frame.
+        Disabled statistics cost a single check per painted item.
+        Painting of the frames rendered in worker threads (see setAsyncRendering()) is reported
+        with the frame in which their image is shown.
+        \since 0.2.3
+    */
+    void setFrameStatsEnabled(bool on);
+    /// Returns true if the statistics of the frames are collected. \sa setFrameStatsEnabled()
+    inline bool frameStatsEnabled() const { return m_statsEnabled; }
+    /// Retrieves statistics of the last painted frame. \sa setFrameStatsEnabled()
+    inline const FrameStats& frameStats() const { return m_lastStats; }
+
+    /// Adds \a count drawn data items to the statistics of the current frame.
+    inline void countSegments(int count) const
+        { if (m_statsEnabled) m_stats.segmentsDrawn += count; }
+    /// Adds \a drawn and \a culled texts to the statistics of the current frame.
+    inline void countLabels(int drawn, int culled = 0) const
+        { if (m_statsEnabled) { m_stats.labelsDrawn += drawn; m_stats.labelsCulled += culled; } }
+
+
+    /// Retrieves X axis object.
+    inline AxisBase* axisX() const { return m_axisX; }
+    /// Retrieves Y axis object.
+    inline AxisBase* axisY() const { return m_axisY; }
+
+
+    /// Sets data model to \a model.
+    void setModel(QAbstractItemModel *model);
+    /// Retrieves active data model or NULL if not set.
+    inline QAbstractItemModel* model() const { return m_model; }
+
+    /// Retrieves numeric snapshot of the model data used for painting.
+    inline const ChartData& chartData() const { return m_data; }
+
+
+    /// \brief Appearance of a data series (model row) taken from the vertical header of the model.
+    /// \since 0.2.3
+    struct SeriesStyle
+    {
+        /// brush of the data items (Qt::BackgroundRole)
+        QBrush brush;
+        /// pen of the value texts (color is Qt::ForegroundRole)
+        QPen textPen;
+    };
+
+    /// Retrieves style of the series at \a row. Valid while painting only.
+    inline const SeriesStyle& seriesStyle(int row) const { return m_styles.at(row); }
+
+
+    /// Retrieves data rectangle (excluding margins and axes).
+    QRect dataRect() const;
+
+    /// Retrieves current mouse cursor position in local coordinates.
+    const QPoint& mousePos() const { return m_mousePos; }
+    /// Retrieves current mouse cursor position in global coordinates.
+    QPoint globalMousePos() const { return mapToGlobal(m_mousePos); }
+
+    /// Retrieves highlighted data model index, or invalid QModelIndex if nothing highlighted.
+    const QModelIndex& highlightedIndex() const { return m_indexUnderMouse; }
+
+    /// Retrieves model index of the data item at \a pos (in local coordinates),
+    /// or invalid QModelIndex if there is no item.
+    virtual QModelIndex indexAt(const QPoint &pos) const;
+
+public Q_SLOTS:
+    /// Invalidates cached content of the plotter and schedules its repaint
+    /// (not earlier than the next frame, see setMaximumFrameRate()).
+    /// Should be called when the data or the appearance of the plotter has been changed.
+    void scheduleUpdate();
+
+protected Q_SLOTS:
+    /// Invalidates the data snapshot (it will be re-read from the model before the next painting).
+    void invalidateData();
+    /// Marks the data snapshot within the range from \a topLeft to \a bottomRight to be updated.
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    /// Marks the series styles to be re-read if the vertical header has been changed.
+    void onHeaderDataChanged(Qt::Orientation orientation, int first, int last);
+    /// Updates the data snapshot after \a removed first columns have been removed
+    /// and \a added columns have been appended to the model.
+    void onColumnsScrolled(int removed, int added);
+    /// Shows \a image rendered in the worker thread for the \a frame unless a newer one is shown already.
+    /// \a stats of the rendering are added to the statistics of the next painted frame.
+    void onFrameRendered(const QImage &image, int frame, const QSint::PlotterBase::FrameStats &stats);
+
+Q_SIGNALS:
+    /// Emitted when the data item at \a index has been entered by the mouse cursor.
+    /// If \a index is invalid that means entering the space without data.
+    void entered(const QModelIndex& index);
+    /// Emitted when the mouse button has been pressed over the data item at \a index.
+    void pressed(const QModelIndex& index);
+    /// Emitted when the mouse button has been clicked over the data item at \a index.
+    void clicked(const QModelIndex& index);
+    /// Emitted when the mouse button has been double clicked over the data item at \a index.
+    void doubleClicked(const QModelIndex& index);
+    /// Emitted after every painted frame with its \a stats if enabled by setFrameStatsEnabled().
+    /// \since 0.2.3
+    void framePainted(const QSint::PlotterBase::FrameStats &stats);
+
+protected:
+    virtual void mousePressEvent(QMouseEvent *event);
+    virtual void mouseDoubleClickEvent(QMouseEvent *event);
+    virtual void mouseReleaseEvent(QMouseEvent *event);
+
+    virtual void mouseMoveEvent(QMouseEvent *event);
+    virtual void leaveEvent(QEvent *event);
+
+    virtual void paintEvent(QPaintEvent *event);
+    virtual void resizeEvent(QResizeEvent *event);
+    virtual void timerEvent(QTimerEvent *event);
+
+    /// Schedules repaint of the plotter for the next frame.
+    void requestUpdate();
+
+    /// Draws default background of the plotter.
+    virtual void drawBackground(QPainter &p);
+    /// Draws default foreground of the plotter.
+    virtual void drawForeground(QPainter &p);
+    /// Draws axes of the plotter.
+    virtual void drawAxes(QPainter &p);
+    /// Draws content of the plotter. Highlighted item should not be taken into account,
+    /// since the content is cached and painted once per data or layout change.
+    virtual void drawContent(QPainter &p) = 0;
+    /// Draws highlighted data item (if any) over the cached content.
+    virtual void drawHighlight(QPainter &p);
+    /** Retrieves rectangle covering everything painted by drawHighlight() when the item
+        at \a index is highlighted, or empty rectangle if \a index is invalid.
+        Only this area is repainted when the highlighted item is changed.
+        Default implementation returns the whole widget rectangle.
+        \since 0.2.3
+    */
+    virtual QRect highlightRect(const QModelIndex &index) const;
+
+    /// Retrieves bounding rectangle of the pie segment within \a pieRect
+    /// from \a angle1 with sweep of \a angle2 (in gradus, counter-clockwise).
+    static QRect pieSegmentRect(const QRect &pieRect, double angle1, double angle2);
+
+    /// Recalculates geometry of the data items used for painting and hit testing.
+    /// Called once after the data or the layout has been changed.
+    virtual void calculateLayout();
+    /// Updates the data snapshot and calls calculateLayout() if the geometry of the data items is out of date.
+    void ensureLayout();
+    /// Re-reads the changed values of the model into the data snapshot.
+    void updateData();
+    /// Re-reads the series styles from the vertical header of the model.
+    void updateStyles();
+    /// Invalidates the cached ticks and labels of the axes (i.e. after the model header has been changed).
+    void invalidateAxes();
+
+    /** Returns horizontal distance (in pixels) the painted content has been moved on
+        after the first \a columns columns have been removed and the same number of columns
+        has been appended, or 0 if the content could not be just scrolled.
+        Default implementation returns 0.
+        \since 0.2.3
+    */
+    virtual int scrollDistance(int columns) const;
+    /// Retrieves horizontal distance the value texts could reach out of their data items.
+    int textMargin() const;
+
+    /// Paints background, axes and content into the cached pixmap (limited by \a clip if not empty).
+    void renderBuffer(const QRect &clip = QRect());
+    /// Paints background, axes and content using painter \a p (limited by \a clip if not empty).
+    void renderLayers(QPainter &p, const QRect &clip = QRect());
+
+    /** Creates a copy of the plotter which renders the same content without accessing the model
+        (used in a worker thread, see setAsyncRendering()). The copy is created in GUI thread
+        after the layout has been calculated; it is never shown and its painting reads only
+        the copied state. Reimplementations should create an instance of their class, call
+        copyState() and copy their own appearance and layout, and return 0 for the subclasses
+        which do not reimplement clone() (their painting would be lost in the copy).
+        Default implementation returns 0 (asynchronous rendering is not supported).
+        \since 0.2.3
+    */
+    virtual PlotterBase* clone() const;
+    /// Copies geometry, appearance, data snapshot and axes of \a other plotter (see clone()).
+    void copyState(const PlotterBase &other);
+    /// Starts rendering of the next frame of \a size (in device pixels) in the worker thread.
+    /// Returns false if the plotter could not be cloned.
+    bool startRender(const QSize &size, qreal dpr);
+    /// Scrolls the cached pixmap on \a dx pixels and paints the exposed areas.
+    void scrollBuffer(int dx);
+
+    /// Returns text of \a value (see formatValue()).
+    QString formattedValue(double value) const;
+    /** Writes text of \a value into \a text reusing its memory. All the value texts
+        (painted ones, highlights and tooltips) are formatted by this method, so it is
+        to be reimplemented to customize them. Default implementation uses textFormat().
+        \since 0.2.3
+    */
+    virtual void formatValue(double value, QString &text) const;
+    /// Returns buffer of the calling thread for the texts formatted while painting.
+    /// A thread paints one frame at a time, so the buffer is reused by all the texts of the frame.
+    static QString& textBuffer();
+
+    void setIndexUnderMouse(const QModelIndex& index);
+
+    AxisBase *m_axisX;
+    AxisBase *m_axisY;
+
+    QAbstractItemModel *m_model;
+    ChartData m_data;
+
+    // changed values of the model which are not in the snapshot yet
+    QBitArray m_dirtyColumns;
+    int m_dirtyTop, m_dirtyBottom;
+    bool m_dirty;
+
+    QVector<SeriesStyle> m_styles;
+    bool m_restyle;
+
+    QBrush m_bg;
+    QPen m_pen;
+
+    QPen m_itemPen;
+    QFont m_font;
+
+    QColor m_hlTextColor;
+    QPen m_hlPen;
+    QBrush m_hlBrush;
+    double m_hlAlpha;
+
+    ValueFormatter m_formatter;
+
+    // cached background, axes and content
+    QPixmap m_buffer;
+    /// number of the columns the cached content is to be scrolled on
+    int m_scrolled;
+    /// the cached content is to be rendered anew
+    bool m_repaint;
+    bool m_relayout;
+    bool m_reload;
+    bool m_antiAliasing;
+
+    int m_frameRate;
+    QBasicTimer m_frameTimer;
+    QElapsedTimer m_frameClock;
+
+    bool m_statsEnabled;
+    /// statistics of the frame being painted and of the last painted one
+    mutable FrameStats m_stats;
+    FrameStats m_lastStats;
+
+    class RenderTask;
+    class BandTask;
+
+    bool m_asyncRendering;
+    QThreadPool m_renderPool;
+    /// the last requested and the last shown frames
+    QAtomicInt m_renderFrame;
+    int m_shownFrame;
+    /// size of the last requested frame, or invalid if rendered synchronously
+    QSize m_renderSize;
+
+    QPoint m_mousePos;
+    QModelIndex m_indexUnderMouse;
+    QModelIndex m_indexClick;
+
+    friend class ChartRenderer;
+};
+
+
+} // namespace
+
+
+Q_DECLARE_METATYPE(QSint::PlotterBase::FrameStats)
+
+
+#endif // PLOTTERBASE_H
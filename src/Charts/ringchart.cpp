@@ -1,218 +1,367 @@
-#include <qmath.h>
-
-#include "ringchart.h"
-
-
-namespace QSint
-{
-
-
-RingChart::RingChart(QWidget *parent) :
-    PlotterBase(parent)
-{
-    setAntiAliasing(true);
-
-    m_margin = 3;
-}
-
-
-void RingChart::setMargin(int margin)
-{
-    if (margin < 0 || margin == m_margin)
-        return;
-
-    m_margin = margin;
-
-    scheduleUpdate();
-}
-
-
-void RingChart::drawContent(QPainter &p)
-{
-    int w = width() - m_margin*2;
-    int h = height() - m_margin*2;
-
-    int wh = qMin(w,h);
-    int wh2 = wh / 2;
-
-    int dx2 = (w - wh) / 2;
-    int dy2 = (h - wh) / 2;
-
-    QRect pieRect = QRect(dx2+m_margin, dy2+m_margin, wh, wh);
-
-    //p.drawEllipse(pieRect);
-
-    if (!m_model)
-        return;
-
-    int row_count = m_model->rowCount();
-    if (!row_count)
-        return;
-
-    int count = m_model->columnCount();
-    if (!count)
-        return;
-
-    // check if need to draw highlight
-    bool checkHighlight = false;
-    double mouseAngle = 0, mouseRadius = 0;
-
-    // check if we're inside piechart at all
-    if (!m_mousePos.isNull() && pieRect.contains(m_mousePos))
-    {
-        // Determine the distance from the center point of the pie chart.
-        double cx = m_mousePos.x() - dx2 - wh2;
-        double cy = dy2 + wh2 - m_mousePos.y();
-        mouseRadius = pow(pow(cx, 2) + pow(cy, 2), 0.5);
-        if (!(mouseRadius == 0 || mouseRadius > wh2)){
-            // Determine the angle of the point.
-            mouseAngle = (180 / M_PI) * acos(cx / mouseRadius);
-            if (cy < 0)
-                mouseAngle = 360 - mouseAngle;
-
-            checkHighlight = true;
-        }
-    }
-
-	// TODO: ^^^ same as by Piechart - merge ^^^
-
-    // draw rings
-    p.setFont(m_font);
-
-	for (int ring = count-1; ring >= 0; ring--)
-	{
-		// inner radius of the ring
-		int r1 = wh2 * ring / count;
-
-		// outer radius of the ring
-		int r2 = wh2 * (ring + 1) / count;
-
-		// check if we are NOT between rings
-		bool ringHighlight = checkHighlight;
-		if (ringHighlight && (mouseRadius <= r1 || mouseRadius >= r2))
-			ringHighlight = false;
-
-		drawRing(p, pieRect.center(), ring, r1, r2, ringHighlight, mouseAngle);
-	}
-
-}
-
-
-void RingChart::drawRing(QPainter &p, const QPoint &center, int ring, int radius1, int radius2, bool checkHighlight, double mouseAngle)
-{
-	int row_count = m_model->rowCount();
-
-	// calculate segments
-    double totalValue = 0;
-
-    for (int r = 0; r < row_count; r++)
-    {
-        const QModelIndex index(m_model->index(r, ring));
-        double value = m_model->data(index).toDouble();
-
-        if (value > 0.0)
-            totalValue += value;
-    }
-
-	// draw segments
-	double startAngle = 0.0;
-    bool isHighlighted = false;
-    double angleHl1, angleHl2, valueHl;
-    QModelIndex indexHl;
-
-	// outer rect
-	QRect pieRect(center.x() - radius2, center.y() - radius2, radius2 * 2, radius2 * 2);
-
-    for (int r = 0; r < row_count; r++)
-    {
-        const QModelIndex index(m_model->index(r, ring));
-        double value = m_model->data(index).toDouble();
-
-        if (value > 0.0) {
-            double angle = 360 * value / totalValue;
-
-
-
-            if (checkHighlight && startAngle <= mouseAngle && mouseAngle <= (startAngle + angle))
-            {
-                isHighlighted = true;
-                angleHl1 = startAngle;
-                angleHl2 = angle;
-                valueHl = value;
-                indexHl = index;
-            }
-            else
-            {            
-				drawSegment(p, pieRect, index, value, startAngle, angle, false);
-                drawValue(p, pieRect, index, value, startAngle, angle, false);
-            }
-
-            startAngle += angle;
-        }
-    }
-
-    // highlight to be drawn over the other segments
-    if (isHighlighted)
-    {
-        setIndexUnderMouse(indexHl);
-
-        drawSegment(p, pieRect, indexHl, valueHl, angleHl1, angleHl2, true);
-        drawValue(p, pieRect, indexHl, valueHl, angleHl1, angleHl2, true);
-    }
-    else
-        setIndexUnderMouse(QModelIndex());
-}
-
-
-void RingChart::drawSegment(QPainter &p, const QRect& pieRect,
-                           const QModelIndex &index, double /*value*/,
-                           double angle1, double angle2,
-                           bool isHighlighted)
-{
-    int r = index.row();
-
-    p.setPen(m_itemPen);
-
-    QBrush brush(qvariant_cast<QBrush>(m_model->headerData(r, Qt::Vertical, Qt::BackgroundRole)));
-    p.setBrush(brush);
-
-    p.drawPie(pieRect, int(angle1*16), int(angle2*16));
-
-	// draw over if highlighted
-    if (isHighlighted)
-    {
-        p.setPen(m_hlPen);
-        p.setBrush(m_hlBrush);
-
-        p.drawPie(pieRect, int(angle1*16), int(angle2*16));
-    }
-}
-
-
-void RingChart::drawValue(QPainter &p, const QRect& pieRect,
-                           const QModelIndex &index, double value,
-                           double angle1, double angle2,
-                           bool isHighlighted)
-{
-    // text (angle CCW in radians)
-    double cr = pieRect.height()/2 - 20;
-    double textAngle = (360 - angle1 - angle2/2) * M_PI / 180;
-    double tx = cr * cos(textAngle) + rect().center().x();
-    double ty = cr * sin(textAngle) + rect().center().y();
-
-    if (isHighlighted)
-    {
-        p.setPen(QPen(m_hlTextColor));
-    }
-    else
-    {
-        QPen pen(qvariant_cast<QColor>(m_model->headerData(index.row(), Qt::Vertical, Qt::ForegroundRole)));
-        p.setPen(pen);
-    }
-
-    p.drawText(tx, ty, formattedValue(value));
-}
-
-
-}
-
+#include <qmath.h>
+#include <typeinfo>
+
+#include "ringchart.h"
+
+
+namespace QSint
+{
+
+
+RingChart::RingChart(QWidget *parent) :
+    PlotterBase(parent)
+{
+    setAntiAliasing(true);
+
+    m_margin = 3;
+}
+
+
+void RingChart::setMargin(int margin)
+{
+    if (margin < 0 || margin == m_margin)
+        return;
+
+    m_margin = margin;
+
+    scheduleUpdate();
+}
+
+
+QRect RingChart::pieRect() const
+{
+    int w = width() - m_margin*2;
+    int h = height() - m_margin*2;
+
+    int wh = qMin(w,h);
+
+    int dx2 = (w - wh) / 2;
+    int dy2 = (h - wh) / 2;
+
+    return QRect(dx2+m_margin, dy2+m_margin, wh, wh);
+}
+
+
+double RingChart::totalValue(int ring) const
+{
+    return m_data.positiveTotal(ring);
+}
+
+
+void RingChart::calculateLayout()
+{
+    m_indexes.clear();
+
+    if (!m_model)
+        return;
+
+    // painting does not access the model
+    int row_count = m_data.rowCount();
+    int count = m_data.columnCount();
+    m_indexes.resize(row_count * count);
+
+    for (int ring = 0; ring < count; ring++)
+        for (int r = 0; r < row_count; r++)
+            m_indexes[ring * row_count + r] = m_model->index(r, ring);
+}
+
+
+PlotterBase* RingChart::clone() const
+{
+    // the copy of a subclass would not paint as the subclass does
+    if (typeid(*this) != typeid(RingChart))
+        return 0;
+
+    RingChart *chart = new RingChart();
+
+    chart->copyState(*this);
+
+    chart->m_margin = m_margin;
+    chart->m_indexes = m_indexes;
+
+    return chart;
+}
+
+
+void RingChart::drawContent(QPainter &p)
+{
+    QRect pieRect = this->pieRect();
+    int wh2 = pieRect.width() / 2;
+
+    //p.drawEllipse(pieRect);
+
+    if (!m_model)
+        return;
+
+    int row_count = m_data.rowCount();
+    if (!row_count)
+        return;
+
+    int count = m_data.columnCount();
+    if (!count || m_indexes.count() != row_count * count)
+        return;
+
+    // draw rings
+    p.setFont(m_font);
+
+	for (int ring = count-1; ring >= 0; ring--)
+	{
+		// inner radius of the ring
+		int r1 = wh2 * ring / count;
+
+		// outer radius of the ring
+		int r2 = wh2 * (ring + 1) / count;
+
+		drawRing(p, pieRect.center(), ring, r1, r2);
+	}
+
+}
+
+
+void RingChart::drawRing(QPainter &p, const QPoint &center, int ring, int /*radius1*/, int radius2)
+{
+	int row_count = m_data.rowCount();
+
+    const double *values = m_data.column(ring);
+
+	// calculate segments
+    double totalValue = this->totalValue(ring);
+
+	// draw segments
+	double startAngle = 0.0;
+
+	// outer rect
+	QRect pieRect(center.x() - radius2, center.y() - radius2, radius2 * 2, radius2 * 2);
+
+    for (int r = 0; r < row_count; r++)
+    {
+        double value = values[r];
+
+        if (value > 0.0) {
+            const QModelIndex &index = m_indexes.at(ring * row_count + r);
+
+            double angle = 360 * value / totalValue;
+
+			drawSegment(p, pieRect, index, value, startAngle, angle, false);
+            drawValue(p, pieRect, index, value, startAngle, angle, false);
+
+            startAngle += angle;
+        }
+    }
+}
+
+
+bool RingChart::segmentGeometry(const QModelIndex &index, QRect &pieRect, double &angle1, double &angle2) const
+{
+    if (!m_model || !index.isValid())
+        return false;
+
+    int ring = index.column();
+    int hr = index.row();
+
+    int count = m_data.columnCount();
+    if (ring >= count || hr >= m_data.rowCount())
+        return false;
+
+    const double *values = m_data.column(ring);
+
+    QRect rect = this->pieRect();
+    QPoint center = rect.center();
+
+    // outer rect of the ring
+    int radius2 = rect.width() / 2 * (ring + 1) / count;
+    pieRect = QRect(center.x() - radius2, center.y() - radius2, radius2 * 2, radius2 * 2);
+
+    double totalValue = this->totalValue(ring);
+
+    // sum the angles of the previous segments
+    angle1 = 0.0;
+
+    for (int r = 0; r < hr; r++)
+    {
+        double value = values[r];
+
+        if (value > 0.0)
+            angle1 += 360 * value / totalValue;
+    }
+
+    angle2 = 360 * values[hr] / totalValue;
+
+    return true;
+}
+
+
+void RingChart::drawHighlight(QPainter &p)
+{
+    QRect pieRect;
+    double startAngle, angleHl;
+    if (!segmentGeometry(m_indexUnderMouse, pieRect, startAngle, angleHl))
+        return;
+
+    double valueHl = m_data.value(m_indexUnderMouse.row(), m_indexUnderMouse.column());
+
+    // highlight to be drawn over the other segments
+    p.setFont(m_font);
+
+    drawSegment(p, pieRect, m_indexUnderMouse, valueHl, startAngle, angleHl, true);
+    drawValue(p, pieRect, m_indexUnderMouse, valueHl, startAngle, angleHl, true);
+}
+
+
+QRect RingChart::highlightRect(const QModelIndex &index) const
+{
+    QRect pieRect;
+    double angle1, angle2;
+    if (!segmentGeometry(index, pieRect, angle1, angle2))
+        return QRect();
+
+    // value text is drawn from its baseline
+    QFontMetrics fm(m_font);
+    QString text(formattedValue(m_data.value(index.row(), index.column())));
+    QPoint pos(valuePos(pieRect, angle1, angle2));
+
+    QRect textRect(pos.x(), pos.y() - fm.ascent(), fm.width(text), fm.height());
+
+    // pen width and antialiasing
+    return (pieSegmentRect(pieRect, angle1, angle2) | textRect).adjusted(-2, -2, 2, 2);
+}
+
+
+QModelIndex RingChart::indexAt(const QPoint &pos) const
+{
+    if (!m_model || pos.isNull())
+        return QModelIndex();
+
+    int row_count = m_data.rowCount();
+    int count = m_data.columnCount();
+    if (!row_count || !count)
+        return QModelIndex();
+
+    int w = width() - m_margin*2;
+    int h = height() - m_margin*2;
+
+    int wh = qMin(w,h);
+    int wh2 = wh / 2;
+
+    int dx2 = (w - wh) / 2;
+    int dy2 = (h - wh) / 2;
+
+    // check if we're inside piechart at all
+    if (!pieRect().contains(pos))
+        return QModelIndex();
+
+    // Determine the distance from the center point of the pie chart.
+    double cx = pos.x() - dx2 - wh2;
+    double cy = dy2 + wh2 - pos.y();
+    double mouseRadius = pow(pow(cx, 2) + pow(cy, 2), 0.5);
+    if (mouseRadius == 0 || mouseRadius > wh2)
+        return QModelIndex();
+
+    // Determine the angle of the point.
+    double mouseAngle = (180 / M_PI) * acos(cx / mouseRadius);
+    if (cy < 0)
+        mouseAngle = 360 - mouseAngle;
+
+	// TODO: ^^^ same as by Piechart - merge ^^^
+
+    for (int ring = count-1; ring >= 0; ring--)
+    {
+        // inner and outer radius of the ring
+        int r1 = wh2 * ring / count;
+        int r2 = wh2 * (ring + 1) / count;
+
+        // check if we are NOT between rings
+        if (mouseRadius <= r1 || mouseRadius >= r2)
+            continue;
+
+        const double *values = m_data.column(ring);
+
+        double totalValue = this->totalValue(ring);
+
+        double startAngle = 0.0;
+
+        for (int r = 0; r < row_count; r++)
+        {
+            double value = values[r];
+
+            if (value > 0.0) {
+                double angle = 360 * value / totalValue;
+
+                if (startAngle <= mouseAngle && mouseAngle <= (startAngle + angle))
+                    return m_model->index(r, ring);
+
+                startAngle += angle;
+            }
+        }
+    }
+
+    return QModelIndex();
+}
+
+
+void RingChart::drawSegment(QPainter &p, const QRect& pieRect,
+                           const QModelIndex &index, double /*value*/,
+                           double angle1, double angle2,
+                           bool isHighlighted)
+{
+    int r = index.row();
+
+    countSegments(1);
+
+    p.setPen(m_itemPen);
+
+    p.setBrush(seriesStyle(r).brush);
+
+    p.drawPie(pieRect, int(angle1*16), int(angle2*16));
+
+	// draw over if highlighted
+    if (isHighlighted)
+    {
+        p.setPen(m_hlPen);
+        p.setBrush(m_hlBrush);
+
+        p.drawPie(pieRect, int(angle1*16), int(angle2*16));
+    }
+}
+
+
+void RingChart::drawValue(QPainter &p, const QRect& pieRect,
+                           const QModelIndex &index, double value,
+                           double angle1, double angle2,
+                           bool isHighlighted)
+{
+    QPoint pos(valuePos(pieRect, angle1, angle2));
+
+    if (isHighlighted)
+    {
+        p.setPen(QPen(m_hlTextColor));
+    }
+    else
+    {
+        p.setPen(seriesStyle(index.row()).textPen);
+    }
+
+    countLabels(1);
+
+    // drawn by the rendering threads as well, so the text is not shared between them
+    QString &text = textBuffer();
+    formatValue(value, text);
+
+    p.drawText(pos, text);
+}
+
+
+QPoint RingChart::valuePos(const QRect& pieRect, double angle1, double angle2) const
+{
+    // text (angle CCW in radians)
+    double cr = pieRect.height()/2 - 20;
+    double textAngle = (360 - angle1 - angle2/2) * M_PI / 180;
+    double tx = cr * cos(textAngle) + rect().center().x();
+    double ty = cr * sin(textAngle) + rect().center().y();
+
+    return QPoint(tx, ty);
+}
+
+
+}
+
@@ -0,0 +1,472 @@
+#include "valueformatter.h"
+
+#include <qmath.h>
+#include <float.h>
+#include <limits.h>
+#include <string.h>
+
+
+namespace QSint
+{
+
+
+ValueFormatter::ValueFormatter(const QString &textFormat)
+{
+    setTextFormat(textFormat);
+}
+
+
+/// Retrieves number of the place marker at \a pos of \a text and its \a length, or 0 if there is no marker.
+static int markerAt(const QString &text, int pos, int &length, bool &localized)
+{
+    const int size = text.size();
+
+    if (text.at(pos) != QLatin1Char('%'))
+        return 0;
+
+    int i = pos + 1;
+
+    localized = (i < size && text.at(i) == QLatin1Char('L'));
+    if (localized)
+        i++;
+
+    if (i >= size || !text.at(i).isDigit())
+        return 0;
+
+    int number = text.at(i++).digitValue();
+
+    if (i < size && text.at(i).isDigit())
+        number = number * 10 + text.at(i++).digitValue();
+
+    length = i - pos;
+
+    return number;
+}
+
+
+void ValueFormatter::setTextFormat(const QString &textFormat)
+{
+    m_format = textFormat;
+    m_parts.clear();
+    m_partsLength = 0;
+    m_compiled = true;
+
+    // just the value
+    if (m_format.isEmpty())
+    {
+        m_parts << QString() << QString();
+        return;
+    }
+
+    // the lowest numbered marker is replaced
+    int lowest = INT_MAX;
+    bool localized = false;
+
+    for (int i = 0; i < m_format.size(); i++)
+    {
+        int length;
+        bool markerLocalized;
+        int number = markerAt(m_format, i, length, markerLocalized);
+
+        if (number > 0 && number <= lowest)
+        {
+            localized = (number < lowest) ? markerLocalized : (localized || markerLocalized);
+            lowest = number;
+        }
+    }
+
+    // locale-aware formatting is left to QString::arg()
+    if (localized)
+    {
+        m_compiled = false;
+        return;
+    }
+
+    int start = 0;
+
+    for (int i = 0; i < m_format.size(); i++)
+    {
+        int length;
+        bool markerLocalized;
+
+        if (markerAt(m_format, i, length, markerLocalized) != lowest)
+            continue;
+
+        m_parts << m_format.mid(start, i - start);
+
+        i += length - 1;
+        start = i + 1;
+    }
+
+    m_parts << m_format.mid(start);
+
+    for (int i = 0; i < m_parts.count(); i++)
+        m_partsLength += m_parts.at(i).size();
+}
+
+
+void ValueFormatter::format(double value, QString &text) const
+{
+    if (!m_compiled)
+    {
+        text = m_format.arg(value);
+        return;
+    }
+
+    char number[MaxNumberLength];
+    int length = formatNumber(value, number);
+
+    int markers = m_parts.count() - 1;
+
+    // reserved capacity is kept by resize(), so the memory is reused by the shorter texts as well
+    text.reserve(m_partsLength + markers * MaxNumberLength);
+    text.resize(m_partsLength + markers * length);
+
+    QChar *out = text.data();
+
+    for (int i = 0; i <= markers; i++)
+    {
+        const QString &part = m_parts.at(i);
+
+        memcpy(out, part.constData(), part.size() * sizeof(QChar));
+        out += part.size();
+
+        if (i == markers)
+            break;
+
+        for (int j = 0; j < length; j++)
+            *out++ = QLatin1Char(number[j]);
+    }
+}
+
+
+QString ValueFormatter::format(double value) const
+{
+    QString text;
+    format(value, text);
+
+    return text;
+}
+
+
+/// Writes decimal digits of \a value (backwards from \a end) and returns pointer to the first one.
+static char* writeDigits(quint64 value, char *end)
+{
+    do
+    {
+        *--end = char('0' + value % 10);
+        value /= 10;
+    }
+    while (value);
+
+    return end;
+}
+
+
+/// Unsigned integer of fixed size, large enough for the exact comparisons of roundDigits().
+struct BigNumber
+{
+    enum { Size = 40 };
+
+    quint32 words[Size];
+    int count;
+
+    explicit BigNumber(quint64 value)
+    {
+        words[0] = quint32(value);
+        words[1] = quint32(value >> 32);
+        count = words[1] ? 2 : 1;
+    }
+
+    void multiply(quint32 factor)
+    {
+        quint64 carry = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            quint64 product = quint64(words[i]) * factor + carry;
+            words[i] = quint32(product);
+            carry = product >> 32;
+        }
+
+        if (carry)
+            words[count++] = quint32(carry);
+    }
+
+    void multiplyPow5(int power)
+    {
+        static const quint32 pow5[] = { 1, 5, 25, 125, 625, 3125, 15625, 78125, 390625,
+                                        1953125, 9765625, 48828125, 244140625, 1220703125 };
+
+        for (; power >= 13; power -= 13)
+            multiply(pow5[13]);
+
+        if (power > 0)
+            multiply(pow5[power]);
+    }
+
+    void shiftLeft(int bits)
+    {
+        int shift = bits / 32;
+        bits %= 32;
+
+        if (bits)
+        {
+            words[count] = 0;
+
+            for (int i = count; i > 0; i--)
+                words[i] = (words[i] << bits) | (words[i - 1] >> (32 - bits));
+
+            words[0] <<= bits;
+
+            if (words[count])
+                count++;
+        }
+
+        if (shift)
+        {
+            for (int i = count - 1; i >= 0; i--)
+                words[i + shift] = words[i];
+
+            for (int i = 0; i < shift; i++)
+                words[i] = 0;
+
+            count += shift;
+        }
+    }
+
+    static int compare(const BigNumber &a, const BigNumber &b)
+    {
+        if (a.count != b.count)
+            return (a.count < b.count) ? -1 : 1;
+
+        for (int i = a.count - 1; i >= 0; i--)
+        {
+            if (a.words[i] != b.words[i])
+                return (a.words[i] < b.words[i]) ? -1 : 1;
+        }
+
+        return 0;
+    }
+};
+
+
+/// Compares \a mantissa * 2^\a binaryExponent with \a digits * 10^\a exponent exactly.
+static int compareExactly(quint64 mantissa, int binaryExponent, quint64 digits, int exponent)
+{
+    BigNumber left(mantissa), right(digits);
+
+    // 10^exponent = 5^exponent * 2^exponent
+    if (exponent >= 0)
+        right.multiplyPow5(exponent);
+    else
+        left.multiplyPow5(-exponent);
+
+    int shift = binaryExponent - exponent;
+    if (shift >= 0)
+        left.shiftLeft(shift);
+    else
+        right.shiftLeft(-shift);
+
+    return BigNumber::compare(left, right);
+}
+
+
+/** Rounds positive \a value to 6 significant digits exactly (ties to even), starting with
+    approximate \a digits of the decimal \a exponent (value ~ digits * 10^(exponent-5)).
+    Returns the digits and corrects \a exponent.
+*/
+static quint64 roundDigits(double value, quint64 digits, int &exponent)
+{
+    // value = mantissa * 2^binaryExponent
+    int binaryExponent;
+    quint64 mantissa = quint64(ldexp(frexp(value, &binaryExponent), 53));
+    binaryExponent -= 53;
+
+    // 10^exponent <= value < 10^(exponent+1)
+    while (compareExactly(mantissa, binaryExponent, 1, exponent) < 0)
+    {
+        exponent--;
+        digits *= 10;
+    }
+
+    while (compareExactly(mantissa, binaryExponent, 1, exponent + 1) >= 0)
+    {
+        exponent++;
+        digits /= 10;
+    }
+
+    digits = qBound(Q_UINT64_C(100000), digits, Q_UINT64_C(999999));
+
+    // compared to the midpoints (digits +- 0.5) * 10^(exponent-5), i.e. value * 2 to (digits * 2 +- 1) * 10^...
+    for (;;)
+    {
+        int c = compareExactly(mantissa, binaryExponent + 1, digits * 2 + 1, exponent - 5);
+        if (c < 0 || (c == 0 && !(digits & 1)))
+            break;
+
+        digits++;
+    }
+
+    while (digits > 100000)
+    {
+        int c = compareExactly(mantissa, binaryExponent + 1, digits * 2 - 1, exponent - 5);
+        if (c > 0 || (c == 0 && !(digits & 1)))
+            break;
+
+        digits--;
+    }
+
+    return digits;
+}
+
+
+int ValueFormatter::formatNumber(double value, char *buffer)
+{
+    char *out = buffer;
+
+    if (value != value)
+    {
+        memcpy(out, "nan", 3);
+        return 3;
+    }
+
+    if (value == 0)
+    {
+        // negative zero is written with the sign as well
+        if (1 / value < 0)
+            *out++ = '-';
+
+        *out = '0';
+        return out - buffer + 1;
+    }
+
+    if (value < 0)
+    {
+        *out++ = '-';
+        value = -value;
+    }
+
+    if (value > DBL_MAX)
+    {
+        memcpy(out, "inf", 3);
+        return out - buffer + 3;
+    }
+
+    char digits[24];
+    char *end = digits + sizeof(digits);
+
+    // integers are written as they are
+    if (value < 1e6 && value == qFloor(value))
+    {
+        char *first = writeDigits(quint64(value), end);
+
+        memcpy(out, first, end - first);
+        return out - buffer + (end - first);
+    }
+
+    // 6 significant digits
+    int exponent = qFloor(log10(value));
+
+    double scaled;
+    if (exponent >= 5)
+        scaled = value / pow(10.0, exponent - 5);
+    else if (exponent > -300)
+        scaled = value * pow(10.0, 5 - exponent);
+    else
+        scaled = value * 1e300 * pow(10.0, 5 - exponent - 300);
+
+    // log10() could be inexact near the powers of 10
+    if (scaled < 100000)
+    {
+        scaled *= 10;
+        exponent--;
+    }
+    else if (scaled >= 1000000)
+    {
+        scaled /= 10;
+        exponent++;
+    }
+
+    quint64 rounded = quint64(scaled);
+    double fraction = scaled - double(rounded);
+
+    // pow() and the scaling are not exact (relative error of a few ulps), so the digits
+    // are rounded exactly near the ties and the powers of 10, as QString::number() does
+    if (qAbs(fraction - 0.5) < 1e-6 || scaled < 100000 + 1e-6 || scaled >= 1000000 - 1e-6)
+        rounded = roundDigits(value, rounded, exponent);
+    else if (fraction > 0.5)
+        rounded++;
+
+    char *first = writeDigits(rounded, end);
+
+    // rounded up to the next power of 10
+    if (end - first > 6)
+    {
+        end--;
+        exponent++;
+    }
+
+    // trailing zeros are not written
+    while (end - first > 1 && end[-1] == '0')
+        end--;
+
+    int count = end - first;
+
+    if (exponent < -4 || exponent >= 6)
+    {
+        // d.ddddde+XX
+        *out++ = first[0];
+
+        if (count > 1)
+        {
+            *out++ = '.';
+            memcpy(out, first + 1, count - 1);
+            out += count - 1;
+        }
+
+        *out++ = 'e';
+        *out++ = (exponent < 0) ? '-' : '+';
+
+        int e = qAbs(exponent);
+        if (e < 10)
+            *out++ = '0';
+
+        char expDigits[8];
+        char *expEnd = expDigits + sizeof(expDigits);
+        char *expFirst = writeDigits(e, expEnd);
+
+        memcpy(out, expFirst, expEnd - expFirst);
+        out += expEnd - expFirst;
+    }
+    else if (exponent >= 0)
+    {
+        // ddd.ddd
+        for (int i = 0; i <= exponent; i++)
+            *out++ = (i < count) ? first[i] : '0';
+
+        if (count > exponent + 1)
+        {
+            *out++ = '.';
+            memcpy(out, first + exponent + 1, count - exponent - 1);
+            out += count - exponent - 1;
+        }
+    }
+    else
+    {
+        // 0.000ddd
+        *out++ = '0';
+        *out++ = '.';
+
+        for (int i = -1; i > exponent; i--)
+            *out++ = '0';
+
+        memcpy(out, first, count);
+        out += count;
+    }
+
+    return out - buffer;
+}
+
+
+} // namespace
@@ -0,0 +1,62 @@
+#ifndef VALUEFORMATTER_H
+#define VALUEFORMATTER_H
+
+
+#include <QString>
+#include <QVector>
+
+
+namespace QSint
+{
+
+
+/**
+    \brief Class converting numeric values to the texts by a format string.
+    \since 0.2.3
+
+    The format is the same as the one of QString::arg(): the lowest numbered place marker
+    (i.e. \a %1) is replaced by the value; empty format means just the value.
+    The values are written as by QString::number() (6 significant digits, no locale).
+
+    The format is parsed once by setTextFormat(), and format() writes the text into a buffer
+    provided by the caller, so formatting of many values into the same string does not allocate
+    memory. Formats having locale-aware markers (i.e. \a %L1) are passed to QString::arg().
+*/
+class ValueFormatter
+{
+public:
+    explicit ValueFormatter(const QString &textFormat = QString());
+
+    /// Sets format of the texts to \a textFormat and parses it.
+    void setTextFormat(const QString &textFormat);
+    /// Retrieves format of the texts.
+    inline const QString& textFormat() const { return m_format; }
+
+    /// Writes text of \a value into \a text (its memory is reused if it is not shared).
+    void format(double value, QString &text) const;
+    /// Returns text of \a value.
+    QString format(double value) const;
+
+    /// Maximal length of a number written by formatNumber().
+    enum { MaxNumberLength = 32 };
+
+    /** Writes \a value as QString::number() does into \a buffer of at least MaxNumberLength
+        characters and returns the number of the characters written.
+    */
+    static int formatNumber(double value, char *buffer);
+
+protected:
+    QString m_format;
+
+    /// parts of the format around the place markers
+    QVector<QString> m_parts;
+    /// total length of the parts
+    int m_partsLength;
+    /// false if the format is passed to QString::arg()
+    bool m_compiled;
+};
+
+
+} // namespace
+
+#endif // VALUEFORMATTER_H